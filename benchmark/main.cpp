@@ -0,0 +1,9 @@
+#include "benchmark.h"
+
+// the same as Project2D.exe -benchmark, but without the window or the
+//   Windows-only leak checking
+// used like: citysim_benchmark [results.csv]
+int main(int argc, char** argv)
+{
+	return runBenchmarks(argc > 1 ? argv[1] : nullptr);
+}
@@ -0,0 +1,61 @@
+// stands in for the parts of the game that need a window, which the
+//   simulation sources refer to but never use when running headless
+// a Simulation made without a Game never draws, takes input, loads
+//   textures or spawns particles, so none of these are ever called
+
+#include "Input.h"
+#include "Texture.h"
+#include "Renderer2D.h"
+#include "gl_core_4_4.h"
+
+#include "game.h"
+#include "uimanager.h"
+
+// the atlas sets texture filtering straight through opengl
+void (CODEGEN_FUNCPTR *_ptrc_glBindTexture)(GLenum, GLuint) = nullptr;
+void (CODEGEN_FUNCPTR *_ptrc_glTexParameteri)(GLenum, GLenum, GLint) =
+	nullptr;
+
+namespace aie {
+
+Input* Input::m_instance = nullptr;
+bool Input::wasKeyPressed(int) { return false; }
+bool Input::isMouseButtonDown(int) { return false; }
+bool Input::wasMouseButtonPressed(int) { return false; }
+
+Texture::Texture()
+	: m_filename("none"), m_width(0), m_height(0), m_glHandle(0),
+	m_format(0), m_loadedPixels(nullptr) {}
+Texture::Texture(unsigned int width, unsigned int height, Format format,
+	unsigned char*)
+	: m_filename("none"), m_width(width), m_height(height), m_glHandle(0),
+	m_format(format), m_loadedPixels(nullptr) {}
+Texture::~Texture() {}
+unsigned char* Texture::loadPixels(const char*, unsigned int*, unsigned int*,
+	Format*) { return nullptr; }
+void Texture::freePixels(unsigned char*) {}
+void Texture::upload(const char*, unsigned int, unsigned int, Format,
+	unsigned char*) {}
+
+SpriteCache::SpriteCache() {}
+SpriteCache::~SpriteCache() {}
+
+void Renderer2D::setRenderColour(float, float, float, float) {}
+void Renderer2D::setRenderColour(unsigned int) {}
+void Renderer2D::setUVRect(float, float, float, float) {}
+void Renderer2D::beginCache(SpriteCache*) {}
+void Renderer2D::endCache() {}
+void Renderer2D::drawCache(SpriteCache*) {}
+
+} // namespace aie
+
+Vector2 Game::getMouseWorldPosition() { return Vector2(); }
+bool Game::isMouseInGame() { return false; }
+void Game::drawTileRect(int, int, int, int) {}
+void Game::setPlaceMode(PlaceMode) {}
+void Game::doScreenShake(float) {}
+void Game::spawnSmokeParticle(const Vector2&) {}
+void Game::spawnPollutionParticle(const Vector2&) {}
+void Game::spawnTextParticle(const Vector2&, std::string) {}
+
+void UiManager::flashMoney() {}
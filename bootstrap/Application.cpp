@@ -4,6 +4,8 @@
 #include <glm/glm.hpp>
 #include <iostream>
 #include "Input.h"
+#include "JobSystem.h"
+#include "Profiler.h"
 #include "imgui_glfw3.h"
 
 namespace aie {
@@ -49,6 +51,9 @@ bool Application::createWindow(const char* title, int width, int height, bool fu
 	// start input manager
 	Input::create();
 
+	// and the threads the game can hand jobs to
+	JobSystem::create();
+
 	// imgui
 	ImGui_Init(m_window, true);
 	
@@ -59,6 +64,7 @@ void Application::destroyWindow() {
 
 	ImGui_Shutdown();
 	Input::destroy();
+	JobSystem::destroy();
 
 	glfwDestroyWindow(m_window);
 	glfwTerminate();
@@ -95,6 +101,9 @@ void Application::run(const char* title, int width, int height, bool fullscreen)
 			if (glfwGetWindowAttrib(m_window, GLFW_ICONIFIED) != 0)
 				continue;
 
+			// everything else this frame shows up inside this zone
+			PROFILE_ZONE("Application::frame");
+
 			// update fps every second
 			frames++;
 			fpsInterval += deltaTime;
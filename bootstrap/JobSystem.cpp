@@ -0,0 +1,226 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+
+namespace aie {
+
+struct Job {
+	std::function<void()>	func;
+	JobCounter*				counter;
+	bool					background;
+};
+
+JobSystem* JobSystem::m_instance = nullptr;
+
+// which queue belongs to the current thread
+// threads that aren't workers (like the one that created the system) use 0
+static thread_local int t_queueIndex = 0;
+
+JobSystem* JobSystem::create(int threadCount) {
+	if (threadCount <= 0)
+		threadCount = (int)std::thread::hardware_concurrency();
+	if (threadCount <= 0)
+		threadCount = 1;
+
+	m_instance = new JobSystem(threadCount);
+	return m_instance;
+}
+
+void JobSystem::destroy() {
+	delete m_instance;
+	m_instance = nullptr;
+}
+
+JobSystem::JobSystem(int threadCount) : m_queuedCount(0), m_running(true) {
+	for (int i = 0; i < threadCount; ++i)
+		m_queues.push_back(new WorkerQueue());
+
+	// queue 0 is the creating thread's, so it doesn't get a worker
+	for (int i = 1; i < threadCount; ++i)
+		m_threads.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(m_sleepLock);
+		m_running = false;
+	}
+	m_wake.notify_all();
+
+	for (auto& thread : m_threads)
+		thread.join();
+
+	// anything never run is just thrown away
+	for (auto queue : m_queues) {
+		for (auto job : queue->jobs)
+			delete job;
+		delete queue;
+	}
+	for (auto job : m_backgroundQueue.jobs)
+		delete job;
+}
+
+void JobSystem::run(std::function<void()> func, JobCounter* counter,
+	JobCounter* dependency) {
+	Job* job = new Job();
+	job->func = std::move(func);
+	job->counter = counter;
+	job->background = false;
+
+	if (counter)
+		counter->m_count++;
+
+	// park it on the dependency until that's done, unless it already is
+	if (dependency) {
+		std::lock_guard<std::mutex> lock(dependency->m_lock);
+		if (!dependency->isDone()) {
+			dependency->m_waiting.push_back(job);
+			return;
+		}
+	}
+
+	push(job);
+}
+
+void JobSystem::runBackground(std::function<void()> func,
+	JobCounter* counter) {
+	Job* job = new Job();
+	job->func = std::move(func);
+	job->counter = counter;
+	job->background = true;
+
+	if (counter)
+		counter->m_count++;
+
+	push(job);
+}
+
+void JobSystem::wait(JobCounter* counter) {
+	while (!counter->isDone()) {
+		Job* job = pop();
+		if (job)
+			execute(job);
+		else
+			std::this_thread::yield();
+	}
+
+	// the last job might still be handing out the counter's waiting jobs,
+	// so make sure it's let go before the counter can be destroyed
+	std::lock_guard<std::mutex> lock(counter->m_lock);
+}
+
+void JobSystem::parallelFor(int count, int batchSize,
+	const std::function<void(int start, int end)>& func) {
+	if (count <= 0)
+		return;
+	if (batchSize < 1)
+		batchSize = 1;
+
+	JobCounter counter;
+	for (int start = 0; start < count; start += batchSize) {
+		int end = std::min(start + batchSize, count);
+		run([&func, start, end]() { func(start, end); }, &counter);
+	}
+	wait(&counter);
+}
+
+void JobSystem::push(Job* job) {
+	// counted before it's queued so the count is never less than what's
+	// actually waiting in the queues
+	m_queuedCount++;
+
+	WorkerQueue* queue = job->background ? &m_backgroundQueue
+		: m_queues[t_queueIndex];
+	{
+		std::lock_guard<std::mutex> lock(queue->lock);
+		queue->jobs.push_back(job);
+	}
+
+	// taking the sleep lock means a worker can't be halfway into sleeping
+	// when it's told to wake up
+	{
+		std::lock_guard<std::mutex> lock(m_sleepLock);
+	}
+	m_wake.notify_one();
+}
+
+Job* JobSystem::pop() {
+	const int queueCount = (int)m_queues.size();
+
+	// newest job from our own queue first, since its data is likely
+	// still in the cache
+	WorkerQueue* own = m_queues[t_queueIndex];
+	{
+		std::lock_guard<std::mutex> lock(own->lock);
+		if (!own->jobs.empty()) {
+			Job* job = own->jobs.back();
+			own->jobs.pop_back();
+			m_queuedCount--;
+			return job;
+		}
+	}
+
+	// then the oldest job from anyone else
+	for (int i = 1; i < queueCount; ++i) {
+		WorkerQueue* victim = m_queues[(t_queueIndex + i) % queueCount];
+		std::lock_guard<std::mutex> lock(victim->lock);
+		if (!victim->jobs.empty()) {
+			Job* job = victim->jobs.front();
+			victim->jobs.pop_front();
+			m_queuedCount--;
+			return job;
+		}
+	}
+
+	// background jobs last, and never on the creating thread unless there's
+	// no one else to run them
+	if (t_queueIndex != 0 || m_threads.empty()) {
+		std::lock_guard<std::mutex> lock(m_backgroundQueue.lock);
+		if (!m_backgroundQueue.jobs.empty()) {
+			Job* job = m_backgroundQueue.jobs.front();
+			m_backgroundQueue.jobs.pop_front();
+			m_queuedCount--;
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+void JobSystem::execute(Job* job) {
+	job->func();
+
+	JobCounter* counter = job->counter;
+	delete job;
+	if (!counter)
+		return;
+
+	// the last job to finish starts everything that was waiting on it
+	std::vector<Job*> ready;
+	{
+		std::lock_guard<std::mutex> lock(counter->m_lock);
+		if (--counter->m_count == 0)
+			ready.swap(counter->m_waiting);
+	}
+	for (auto waiting : ready)
+		push(waiting);
+}
+
+void JobSystem::workerLoop(int queueIndex) {
+	t_queueIndex = queueIndex;
+
+	while (m_running) {
+		Job* job = pop();
+		if (job) {
+			PROFILE_ZONE("JobSystem::job");
+			execute(job);
+			continue;
+		}
+
+		// nothing to do, so sleep until something's queued
+		std::unique_lock<std::mutex> lock(m_sleepLock);
+		m_wake.wait(lock, [this]() { return m_queuedCount > 0 || !m_running; });
+	}
+}
+
+} // namespace aie
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+namespace aie {
+
+struct Job;
+
+// counts how many jobs are still to finish, so they can be waited on or
+// have other jobs wait for them before they start
+// a counter has to be waited on before it goes out of scope
+class JobCounter {
+public:
+
+	JobCounter() : m_count(0) {}
+	~JobCounter() = default;
+
+	// a counter is shared by its jobs, so it can't be copied or moved
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	// whether every job using this counter has finished
+	bool isDone() const { return m_count == 0; }
+
+private:
+
+	friend class JobSystem;
+
+	std::atomic<int>	m_count;
+
+	// jobs that can't start until this counter is done
+	std::mutex			m_lock;
+	std::vector<Job*>	m_waiting;
+};
+
+// spreads jobs across a thread per core
+// each thread has its own queue of jobs which it takes the newest job from,
+// and when it runs out it steals the oldest jobs from the other threads
+// the thread that created the job system counts as one of the threads, and
+// runs jobs whenever it waits for them, except background jobs
+class JobSystem {
+public:
+
+	// threadCount includes the creating thread, 0 means one per core
+	static JobSystem* create(int threadCount = 0);
+	static void destroy();
+	static JobSystem* getInstance() { return m_instance; }
+
+	// how many threads run jobs, including the one that created the system
+	int getThreadCount() const { return (int)m_queues.size(); }
+
+	// queues a function to be run on any thread
+	// counter (if given) isn't done until the job has finished, and the job
+	// won't start until dependency (if given) is done
+	void run(std::function<void()> func, JobCounter* counter = nullptr,
+		JobCounter* dependency = nullptr);
+
+	// queues a slow function (like loading a file) that only the worker
+	// threads run, so the creating thread never gets stuck in one while
+	// waiting on something else
+	// with no worker threads, it's run by whichever thread waits on it
+	void runBackground(std::function<void()> func,
+		JobCounter* counter = nullptr);
+
+	// runs other jobs until every job using the counter has finished
+	void wait(JobCounter* counter);
+
+	// splits the indices [0, count) into batches of batchSize, calls
+	// func(start, end) for each batch across all threads, and waits for
+	// them to finish
+	void parallelFor(int count, int batchSize,
+		const std::function<void(int start, int end)>& func);
+
+private:
+
+	// each thread's queue, the owner works from the back and thieves steal
+	// from the front
+	struct WorkerQueue {
+		std::mutex			lock;
+		std::deque<Job*>	jobs;
+	};
+
+	JobSystem(int threadCount);
+	~JobSystem();
+
+	// adds a job that's ready to start to the calling thread's queue, or
+	// the background queue for background jobs
+	void push(Job* job);
+	// takes a job from the calling thread's queue, or steals one, and only
+	// then a background job (if the calling thread is allowed them)
+	// returns nullptr if there's nothing to do anywhere
+	Job* pop();
+	// runs a job and lets anything waiting for it know it's done
+	void execute(Job* job);
+	// what each worker thread does until the system is destroyed
+	void workerLoop(int queueIndex);
+
+	std::vector<WorkerQueue*>	m_queues;
+	// background jobs, shared by the worker threads
+	WorkerQueue					m_backgroundQueue;
+	std::vector<std::thread>	m_threads;
+
+	// how many jobs are sitting in queues, so idle threads know to wake up
+	std::atomic<int>			m_queuedCount;
+	std::atomic<bool>			m_running;
+	std::mutex					m_sleepLock;
+	std::condition_variable		m_wake;
+
+	static JobSystem* m_instance;
+};
+
+} // namespace aie
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "Profiler.h"
+#include <chrono>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+// how many threads can record zones, any more than this are counted in the
+// trace but their zones are ignored
+// buffers are only made for threads that record something, so this can be
+// far more than there are cores
+#define AIE_PROFILE_MAX_THREADS 256
+
+namespace aie {
+
+// each thread writes into its own buffer so recording never has to lock,
+// wrapping around and overwriting the oldest zones once it's full
+struct ProfileBuffer {
+	Profiler::Zone		zones[AIE_PROFILE_BUFFER_SIZE];
+	// how many zones have ever been recorded, so the next one goes in
+	// count % AIE_PROFILE_BUFFER_SIZE
+	unsigned long long	count;
+};
+
+// each thread's buffer is made the first time it records a zone
+// a buffer is only published once it's ready, so the trace can skip any
+// that are still being made
+static std::atomic<ProfileBuffer*> s_buffers[AIE_PROFILE_MAX_THREADS];
+static std::atomic<int> s_bufferCount(0);
+
+static const std::chrono::high_resolution_clock::time_point s_startTime =
+	std::chrono::high_resolution_clock::now();
+
+static ProfileBuffer* getThreadBuffer() {
+	// -1 means this thread hasn't asked for a buffer yet
+	thread_local int bufferIndex = -1;
+	if (bufferIndex < 0) {
+		bufferIndex = s_bufferCount++;
+		if (bufferIndex < AIE_PROFILE_MAX_THREADS)
+			s_buffers[bufferIndex] = new ProfileBuffer();
+	}
+
+	if (bufferIndex >= AIE_PROFILE_MAX_THREADS)
+		return nullptr;
+	return s_buffers[bufferIndex];
+}
+
+unsigned long long Profiler::now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::high_resolution_clock::now() - s_startTime).count();
+}
+
+void Profiler::record(const char* name, unsigned long long start, unsigned long long end) {
+	ProfileBuffer* buffer = getThreadBuffer();
+	if (buffer == nullptr)
+		return;
+
+	Zone& zone = buffer->zones[buffer->count % AIE_PROFILE_BUFFER_SIZE];
+	zone.name = name;
+	zone.start = start;
+	zone.end = end;
+	buffer->count++;
+}
+
+bool Profiler::writeChromeTrace(const char* filename) {
+	std::ofstream file(filename);
+	if (!file.is_open())
+		return false;
+
+	// chrome wants microseconds, and fixed point keeps long sessions exact
+	file << std::fixed << std::setprecision(3);
+	file << "{\"traceEvents\":[";
+
+	bool first = true;
+	int threadCount = s_bufferCount;
+
+	// say so in the trace if any threads couldn't be recorded, rather than
+	// their zones just being missing
+	if (threadCount > AIE_PROFILE_MAX_THREADS) {
+		file << "\n{\"name\":\"profiler ran out of thread buffers, "
+			<< threadCount - AIE_PROFILE_MAX_THREADS
+			<< " threads were dropped\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,"
+			<< "\"tid\":0,\"ts\":0}";
+		first = false;
+		threadCount = AIE_PROFILE_MAX_THREADS;
+	}
+
+	// other threads might still be recording, which can only ever mess up
+	// the zones that are being overwritten right now
+	for (int thread = 0; thread < threadCount; ++thread) {
+		const ProfileBuffer* buffer = s_buffers[thread];
+		if (buffer == nullptr)
+			continue;
+
+		unsigned long long count = buffer->count;
+		unsigned long long oldest = 0;
+		if (count > AIE_PROFILE_BUFFER_SIZE)
+			oldest = count - AIE_PROFILE_BUFFER_SIZE;
+
+		for (unsigned long long i = oldest; i < count; ++i) {
+			const Zone& zone = buffer->zones[i % AIE_PROFILE_BUFFER_SIZE];
+
+			if (!first)
+				file << ",";
+			first = false;
+
+			file << "\n{\"name\":\"";
+			for (const char* c = zone.name; *c; ++c) {
+				if (*c == '"' || *c == '\\')
+					file << '\\';
+				file << *c;
+			}
+			file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread + 1
+				<< ",\"ts\":" << zone.start / 1000.0
+				<< ",\"dur\":" << (zone.end - zone.start) / 1000.0 << "}";
+		}
+	}
+
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return true;
+}
+
+unsigned long long Profiler::getTotalTime(const char* name) {
+	int threadCount = s_bufferCount;
+	if (threadCount > AIE_PROFILE_MAX_THREADS)
+		threadCount = AIE_PROFILE_MAX_THREADS;
+
+	unsigned long long total = 0;
+	for (int thread = 0; thread < threadCount; ++thread) {
+		const ProfileBuffer* buffer = s_buffers[thread];
+		if (buffer == nullptr)
+			continue;
+
+		unsigned long long count = buffer->count;
+		unsigned long long oldest = 0;
+		if (count > AIE_PROFILE_BUFFER_SIZE)
+			oldest = count - AIE_PROFILE_BUFFER_SIZE;
+
+		// the same literal can end up at different addresses in different
+		// files, so the names themselves are compared
+		for (unsigned long long i = oldest; i < count; ++i) {
+			const Zone& zone = buffer->zones[i % AIE_PROFILE_BUFFER_SIZE];
+			if (strcmp(zone.name, name) == 0)
+				total += zone.end - zone.start;
+		}
+	}
+	return total;
+}
+
+void Profiler::clear() {
+	int threadCount = s_bufferCount;
+	if (threadCount > AIE_PROFILE_MAX_THREADS)
+		threadCount = AIE_PROFILE_MAX_THREADS;
+
+	for (int thread = 0; thread < threadCount; ++thread) {
+		ProfileBuffer* buffer = s_buffers[thread];
+		if (buffer)
+			buffer->count = 0;
+	}
+}
+
+void Profiler::shutdown() {
+	// threads that recorded before keep their index, so they'll find no
+	// buffer there and record nothing from now on
+	for (auto& buffer : s_buffers)
+		delete buffer.exchange(nullptr);
+}
+
+} // namespace aie
\ No newline at end of file
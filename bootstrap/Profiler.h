@@ -0,0 +1,88 @@
+#pragma once
+
+// set AIE_PROFILE to 0 (e.g. in the project's preprocessor definitions)
+// to compile every profiling zone out completely
+#ifndef AIE_PROFILE
+#define AIE_PROFILE 1
+#endif
+
+// how many zones each thread remembers before overwriting its oldest ones
+#define AIE_PROFILE_BUFFER_SIZE 32768
+
+namespace aie {
+
+// records how long named zones of code take on each thread so they can be
+// looked at afterwards in chrome://tracing (or ui.perfetto.dev)
+// zones that are opened inside other zones show up nested inside them
+class Profiler {
+public:
+
+	// a finished zone, times are in nanoseconds since the profiler started
+	struct Zone {
+		const char*			name;
+		unsigned long long	start;
+		unsigned long long	end;
+	};
+
+	// gets the current time in nanoseconds since the profiler started
+	static unsigned long long now();
+
+	// records a finished zone in the calling thread's ring buffer
+	// the name must stay around until the trace has been written, so it
+	// should be a string literal
+	static void record(const char* name, unsigned long long start, unsigned long long end);
+
+	// writes every remembered zone from every thread to a chrome trace json file
+	// returns false if the file couldn't be opened
+	static bool writeChromeTrace(const char* filename);
+
+	// adds up how long every remembered zone with this name took, from every
+	// thread, in nanoseconds
+	static unsigned long long getTotalTime(const char* name);
+
+	// forgets every remembered zone
+	static void clear();
+
+	// frees every thread's buffer, nothing is recorded after this
+	// only call it once every other thread has stopped, like just before
+	// checking for leaks
+	static void shutdown();
+};
+
+// times the scope it's declared in
+class ProfileZone {
+public:
+
+	ProfileZone(const char* name) : m_name(name), m_start(Profiler::now()) {}
+	~ProfileZone() { Profiler::record(m_name, m_start, Profiler::now()); }
+
+private:
+
+	const char*			m_name;
+	unsigned long long	m_start;
+};
+
+} // namespace aie
+
+#if AIE_PROFILE
+
+#define AIE_PROFILE_JOIN2(a, b) a##b
+#define AIE_PROFILE_JOIN(a, b) AIE_PROFILE_JOIN2(a, b)
+
+// times from here to the end of the current scope
+#define PROFILE_ZONE(name) aie::ProfileZone AIE_PROFILE_JOIN(profileZone, __LINE__)(name)
+// times the rest of the current function, named after it
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
+// writes everything recorded so far to a chrome trace file
+#define PROFILE_DUMP(filename) aie::Profiler::writeChromeTrace(filename)
+// frees the profiler's memory, once nothing else is running
+#define PROFILE_SHUTDOWN() aie::Profiler::shutdown()
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_DUMP(filename)
+#define PROFILE_SHUTDOWN()
+
+#endif
\ No newline at end of file
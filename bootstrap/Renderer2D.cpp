@@ -3,12 +3,31 @@
 #include "Renderer2D.h"
 #include "Texture.h"
 #include "Font.h"
+#include "Profiler.h"
 #include <glm/ext.hpp>
 #include <stb_truetype.h>
+#include <cstring>
 
 namespace aie {
 
-Renderer2D::Renderer2D() {
+SpriteCache::SpriteCache() : m_vao(0), m_vbo(0), m_ibo(0), m_indexCount(0),
+	m_indexType(GL_UNSIGNED_SHORT), m_textureCount(0) {
+	for (int i = 0; i < MAX_TEXTURES; i++) {
+		m_textures[i] = nullptr;
+		m_fontTexture[i] = 0;
+	}
+}
+
+SpriteCache::~SpriteCache() {
+	// the buffers are only made the first time something is recorded
+	if (m_vao != 0) {
+		glDeleteBuffers(1, &m_vbo);
+		glDeleteBuffers(1, &m_ibo);
+		glDeleteVertexArrays(1, &m_vao);
+	}
+}
+
+Renderer2D::Renderer2D(int maxSprites) {
 
 	setRenderColour(1,1,1,1);
 	setUVRect(0.0f, 0.0f, 1.0f, 1.0f);
@@ -20,9 +39,28 @@ Renderer2D::Renderer2D() {
 	unsigned int pixels[1] = {0xFFFFFFFF};
 	m_nullTexture = new Texture(1, 1, Texture::RGBA, (unsigned char*)pixels);
 
+	m_maxSprites = maxSprites > 0 ? maxSprites : DEFAULT_MAX_SPRITES;
+	m_vertices = new SBVertex[m_maxSprites * 4];
+	m_indices = new unsigned int[m_maxSprites * 6];
+
+	// 16-bit indices are half the size, so only go to 32-bit if a batch
+	// has more vertices than they can reach
+	if (m_maxSprites * 4 <= 65536) {
+		m_indexType = GL_UNSIGNED_SHORT;
+		m_indexSize = sizeof(unsigned short);
+	}
+	else {
+		m_indexType = GL_UNSIGNED_INT;
+		m_indexSize = sizeof(unsigned int);
+	}
+
 	m_currentVertex = 0;
 	m_currentIndex = 0;
+	m_ringVertex = 0;
+	m_ringIndex = 0;
+	m_flushCount = 0;
 	m_renderBegun = false;
+	m_recording = nullptr;
 
 	m_vao = -1;
 	m_vbo = -1;
@@ -107,43 +145,37 @@ Renderer2D::Renderer2D() {
 	glDeleteShader(vs);
 	glDeleteShader(fs);
 	
-	// pre calculate the indices... they will always be the same
-	int index = 0;
-	for (int i = 0; i<(MAX_SPRITES*6);) {
-		m_indices[i++] = (index + 0);
-		m_indices[i++] = (index + 1);
-		m_indices[i++] = (index + 2);
-
-		m_indices[i++] = (index + 0);
-		m_indices[i++] = (index + 2);
-		m_indices[i++] = (index + 3);
-		index += 4;
-	}
-	
 	// create the vao, vio and vbo
+	// they're streamed into every flush, so they start out empty
 	glGenVertexArrays(1, &m_vao);
 	glBindVertexArray(m_vao);
 	glGenBuffers(1, &m_vbo);
 	glGenBuffers(1, &m_ibo);
 	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (MAX_SPRITES * 6) * sizeof(unsigned short), (void *)(&m_indices[0]), GL_STATIC_DRAW);
-	glBufferData(GL_ARRAY_BUFFER, (MAX_SPRITES * 4) * sizeof(SBVertex), m_vertices, GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (m_maxSprites * 6 * RING_BATCHES) * m_indexSize, nullptr, GL_STREAM_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, (m_maxSprites * 4 * RING_BATCHES) * sizeof(SBVertex), nullptr, GL_STREAM_DRAW);
+	setVertexLayout();
+	glBindVertexArray(0);
+}
+
+void Renderer2D::setVertexLayout() {
 	glEnableVertexAttribArray(0);
 	glEnableVertexAttribArray(1);
 	glEnableVertexAttribArray(2);
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(SBVertex), (char *)0);
 	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(SBVertex), (char *)16);
 	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(SBVertex), (char *)32);
-	glBindVertexArray(0);
 }
 
 Renderer2D::~Renderer2D() {
 	glDeleteBuffers(1, &m_vbo);
 	glDeleteBuffers(1, &m_ibo);
-	glDeleteBuffers(1, &m_vao);
+	glDeleteVertexArrays(1, &m_vao);
 	glDeleteProgram(m_shader);
 	delete m_nullTexture;
+	delete[] m_vertices;
+	delete[] m_indices;
 }
 
 void Renderer2D::begin() {
@@ -151,6 +183,7 @@ void Renderer2D::begin() {
 	m_currentIndex = 0;
 	m_currentVertex = 0;
 	m_currentTexture = 0;
+	m_flushCount = 0;
 
 	int width = 0, height = 0;
 	auto window = glfwGetCurrentContext();
@@ -650,13 +683,132 @@ void Renderer2D::drawText(Font * font, const char* text, float xPos, float yPos,
 	}
 }
 
+void Renderer2D::beginCache(SpriteCache* cache) {
+	// anything already waiting to be drawn isn't part of the cache
+	flushBatch();
+
+	for (unsigned int i = 0; i < TEXTURE_STACK_SIZE; i++) {
+		m_textureStack[i] = nullptr;
+		m_fontTexture[i] = 0;
+	}
+	m_currentIndex = 0;
+	m_currentVertex = 0;
+	m_currentTexture = 0;
+
+	m_recording = cache;
+	m_cacheVertices.clear();
+	m_cacheIndices.clear();
+}
+
+void Renderer2D::endCache() {
+	if (m_recording == nullptr)
+		return;
+
+	// moves whatever's left in the batch into the recording
+	flushBatch();
+
+	SpriteCache* cache = m_recording;
+	m_recording = nullptr;
+
+	if (cache->m_vao == 0) {
+		glGenVertexArrays(1, &cache->m_vao);
+		glBindVertexArray(cache->m_vao);
+		glGenBuffers(1, &cache->m_vbo);
+		glGenBuffers(1, &cache->m_ibo);
+		glBindBuffer(GL_ARRAY_BUFFER, cache->m_vbo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cache->m_ibo);
+		setVertexLayout();
+	}
+	else {
+		glBindVertexArray(cache->m_vao);
+		glBindBuffer(GL_ARRAY_BUFFER, cache->m_vbo);
+	}
+
+	glBufferData(GL_ARRAY_BUFFER, m_cacheVertices.size() * sizeof(SBVertex),
+		m_cacheVertices.data(), GL_STATIC_DRAW);
+
+	// 16-bit indices if they can reach every vertex, like batches
+	if (m_cacheVertices.size() <= 65536) {
+		std::vector<unsigned short> shortIndices(m_cacheIndices.begin(), m_cacheIndices.end());
+		cache->m_indexType = GL_UNSIGNED_SHORT;
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(unsigned short),
+			shortIndices.data(), GL_STATIC_DRAW);
+	}
+	else {
+		cache->m_indexType = GL_UNSIGNED_INT;
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_cacheIndices.size() * sizeof(unsigned int),
+			m_cacheIndices.data(), GL_STATIC_DRAW);
+	}
+	glBindVertexArray(0);
+
+	cache->m_indexCount = (int)m_cacheIndices.size();
+	cache->m_textureCount = m_currentTexture;
+	for (unsigned int i = 0; i < TEXTURE_STACK_SIZE; i++) {
+		cache->m_textures[i] = m_textureStack[i];
+		cache->m_fontTexture[i] = m_fontTexture[i];
+
+		m_textureStack[i] = nullptr;
+		m_fontTexture[i] = 0;
+	}
+	m_currentTexture = 0;
+}
+
+void Renderer2D::drawCache(SpriteCache* cache) {
+	if (m_renderBegun == false || m_recording != nullptr || cache->m_indexCount == 0)
+		return;
+
+	PROFILE_ZONE("Renderer2D::drawCache");
+
+	// keep the drawing order, so anything drawn before goes first
+	flushBatch();
+
+	// put the textures back in the slots the sprites were recorded with
+	char buf[32];
+	for (unsigned int i = 0; i < cache->m_textureCount; ++i) {
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, cache->m_textures[i]->getHandle());
+
+		sprintf_s(buf, "isFontTexture[%i]", i);
+		glUniform1i(glGetUniformLocation(m_shader, buf), cache->m_fontTexture[i]);
+	}
+	glActiveTexture(GL_TEXTURE0);
+
+	int depthFunc = GL_LESS;
+	glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+	glDepthFunc(GL_LEQUAL);
+
+	glBindVertexArray(cache->m_vao);
+	glDrawElements(GL_TRIANGLES, cache->m_indexCount, cache->m_indexType, 0);
+	glBindVertexArray(0);
+
+	glDepthFunc(depthFunc);
+
+	m_flushCount++;
+}
+
 bool Renderer2D::shouldFlush(int additionalVertices, int additionalIndices) {
-	return (m_currentVertex + additionalVertices) >= (MAX_SPRITES * 4) || 
-		(m_currentIndex + additionalIndices) >= (MAX_SPRITES * 6);
+	return (m_currentVertex + additionalVertices) >= (m_maxSprites * 4) || 
+		(m_currentIndex + additionalIndices) >= (m_maxSprites * 6);
 }
 
 void Renderer2D::flushBatch() {
 
+	PROFILE_ZONE("Renderer2D::flushBatch");
+
+	// when recording, the batch goes on the end of the cache instead
+	// the textures stay where they are, so every sprite in the cache
+	// agrees on which slot is which texture
+	if (m_recording != nullptr) {
+		unsigned int firstVertex = (unsigned int)m_cacheVertices.size();
+		m_cacheVertices.insert(m_cacheVertices.end(), m_vertices, m_vertices + m_currentVertex);
+		for (int i = 0; i < m_currentIndex; ++i)
+			m_cacheIndices.push_back(firstVertex + m_indices[i]);
+
+		m_currentIndex = 0;
+		m_currentVertex = 0;
+		return;
+	}
+
 	// dont render anything
 	if (m_currentVertex == 0 || m_currentIndex == 0 || m_renderBegun == false)
 		return; char buf[32];
@@ -674,10 +826,52 @@ void Renderer2D::flushBatch() {
 	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
 
-	glBufferSubData(GL_ARRAY_BUFFER, 0, m_currentVertex * sizeof(SBVertex), m_vertices);
-	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, m_currentIndex * sizeof(unsigned short), m_indices);
+	// once the ring is full, start again at the front of fresh storage
+	// the old storage is orphaned, so the driver keeps it around until the
+	// GPU has finished drawing from it instead of making us wait
+	int ringVertices = m_maxSprites * 4 * RING_BATCHES;
+	int ringIndices = m_maxSprites * 6 * RING_BATCHES;
+	if (m_ringVertex + m_currentVertex > ringVertices ||
+		m_ringIndex + m_currentIndex > ringIndices) {
+		glBufferData(GL_ARRAY_BUFFER, ringVertices * sizeof(SBVertex), nullptr, GL_STREAM_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, ringIndices * m_indexSize, nullptr, GL_STREAM_DRAW);
+		m_ringVertex = 0;
+		m_ringIndex = 0;
+	}
 
-	glDrawElements(GL_TRIANGLES, m_currentIndex, GL_UNSIGNED_SHORT, 0);
+	// this part of the ring hasn't been drawn from since it was last
+	// orphaned, so there's no need to sync with the GPU
+	const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+
+	void* vertices = glMapBufferRange(GL_ARRAY_BUFFER, m_ringVertex * sizeof(SBVertex),
+		m_currentVertex * sizeof(SBVertex), access);
+	if (vertices != nullptr) {
+		memcpy(vertices, m_vertices, m_currentVertex * sizeof(SBVertex));
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+
+	void* indices = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, m_ringIndex * m_indexSize,
+		m_currentIndex * m_indexSize, access);
+	if (indices != nullptr) {
+		if (m_indexType == GL_UNSIGNED_INT) {
+			memcpy(indices, m_indices, m_currentIndex * sizeof(unsigned int));
+		}
+		else {
+			unsigned short* shortIndices = (unsigned short*)indices;
+			for (int i = 0; i < m_currentIndex; ++i)
+				shortIndices[i] = (unsigned short)m_indices[i];
+		}
+		glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+	}
+
+	// the batch's indices start from 0, so offset them to where its
+	// vertices are in the ring
+	glDrawElementsBaseVertex(GL_TRIANGLES, m_currentIndex, m_indexType,
+		(void*)(size_t)(m_ringIndex * m_indexSize), m_ringVertex);
+
+	m_ringVertex += m_currentVertex;
+	m_ringIndex += m_currentIndex;
+	m_flushCount++;
 
 	glBindVertexArray(0);
 
@@ -705,8 +899,14 @@ unsigned int Renderer2D::pushTexture(Texture* texture) {
 	}
 
 	// if we've used all the textures we can, than we need to flush to make room for another texture change
-	if (m_currentTexture >= TEXTURE_STACK_SIZE - 1)
+	if (m_currentTexture >= TEXTURE_STACK_SIZE - 1) {
+		// a cache can't change its textures part way through
+		if (m_recording != nullptr) {
+			printf("Error: Too many textures used in one SpriteCache!\n");
+			return 0;
+		}
 		flushBatch();
+	}
 
 	// add the texture to our active texture list
 	m_textureStack[m_currentTexture] = texture;
@@ -1,15 +1,56 @@
 #pragma once
 
+#include <vector>
+
 namespace aie {
 
 class Texture;
 class Font;
 
+// sprites recorded once and kept on the GPU, so they can be drawn again
+// with a single call until they change
+// record into one with Renderer2D::beginCache / endCache and draw it with
+// Renderer2D::drawCache
+class SpriteCache {
+public:
+
+	SpriteCache();
+	~SpriteCache();
+
+	// a cache owns its GPU buffers, so it can't be copied
+	SpriteCache(const SpriteCache&) = delete;
+	SpriteCache& operator=(const SpriteCache&) = delete;
+
+	// whether anything has been recorded into the cache
+	bool isEmpty() const { return m_indexCount == 0; }
+
+private:
+
+	friend class Renderer2D;
+
+	// the same as Renderer2D's texture stack
+	enum { MAX_TEXTURES = 16 };
+
+	unsigned int	m_vao, m_vbo, m_ibo;
+	int				m_indexCount;
+	unsigned int	m_indexType;
+
+	// the textures the sprites use, in the slots they were recorded with
+	Texture*		m_textures[MAX_TEXTURES];
+	int				m_fontTexture[MAX_TEXTURES];
+	unsigned int	m_textureCount;
+};
+
 // a class for rendering 2D sprites and font
 class Renderer2D {
 public:
 
-	Renderer2D();
+	// how many sprites can be drawn before the batch has to be flushed,
+	// unless the renderer is given its own number
+	enum { DEFAULT_MAX_SPRITES = 16384 };
+
+	// maxSprites sets how big each batch can be
+	Renderer2D(int maxSprites = DEFAULT_MAX_SPRITES);
 	virtual ~Renderer2D();
 
 	// all draw calls must occur between a begin / end pair
@@ -34,6 +75,17 @@ public:
 	// depth is in the range [0,100] with lower being closer to the viewer
 	virtual void drawText(Font* font, const char* text, float xPos, float yPos, float depth = 0.0f);
 
+	// every draw call between beginCache and endCache is recorded into the
+	// cache instead of being drawn, replacing what it had before
+	// a cache can use up to TEXTURE_STACK_SIZE - 1 different textures
+	void beginCache(SpriteCache* cache);
+	void endCache();
+
+	// draws everything recorded into a cache with one draw call, on top of
+	// anything drawn before it
+	// must be called between begin / end like other draw calls
+	void drawCache(SpriteCache* cache);
+
 	// sets the tint colour for all subsequent draw calls
 	void setRenderColour(float r, float g, float b, float a = 1.0f);
 	void setRenderColour(unsigned int colour);
@@ -50,12 +102,20 @@ public:
 	void setCameraScale(float scale) { m_cameraScale = scale; }
 	float getCameraScale() { return m_cameraScale; }
 
+	// how many sprites fit in one batch
+	int getMaxSprites() const { return m_maxSprites; }
+
+	// how many batches have been sent to the GPU since begin(), so
+	// anything breaking batches up can be spotted
+	int getFlushCount() const { return m_flushCount; }
+
 protected:
 
 	// helper methods used during drawing
 	bool shouldFlush(int additionalVertices = 0, int additionalIndices = 0);
 	void flushBatch();
 	unsigned int pushTexture(Texture* texture);
+	void setVertexLayout();
 
 	// indicates in the middle of a begin/end pair
 	bool				m_renderBegun;
@@ -78,7 +138,9 @@ protected:
 	float				m_r, m_g, m_b, m_a;
 
 	// sprite handling
-	enum { MAX_SPRITES = 512 };
+	// the GPU buffers hold this many batches end to end, so a batch can be
+	// written while the GPU is still drawing the ones before it
+	enum { RING_BATCHES = 3 };
 	struct SBVertex {
 		float pos[4];
 		float color[4];
@@ -86,10 +148,24 @@ protected:
 	};
 
 	// data used for opengl to draw the sprites (with padding)
-	SBVertex			m_vertices[MAX_SPRITES * 4];
-	unsigned short		m_indices[MAX_SPRITES * 6];
+	// indices are 32-bit when a batch has more vertices than 16-bit
+	// indices can reach
+	int					m_maxSprites;
+	SBVertex*			m_vertices;
+	unsigned int*		m_indices;
 	int					m_currentVertex, m_currentIndex;
 	unsigned int		m_vao, m_vbo, m_ibo;
+	unsigned int		m_indexType;
+	int					m_indexSize;
+
+	// where the next batch goes in the GPU buffers, in vertices and indices
+	int					m_ringVertex, m_ringIndex;
+	int					m_flushCount;
+
+	// the cache being recorded into, and what's been recorded so far
+	SpriteCache*				m_recording;
+	std::vector<SBVertex>		m_cacheVertices;
+	std::vector<unsigned int>	m_cacheIndices;
 
 	// shader used to render sprites
 	unsigned int		m_shader;
@@ -45,53 +45,74 @@ Texture::~Texture() {
 
 bool Texture::load(const char* filename) {
 
+	unsigned int width = 0, height = 0;
+	Format format = RGBA;
+	unsigned char* pixels = loadPixels(filename, &width, &height, &format);
+	if (pixels == nullptr)
+		return false;
+
+	upload(filename, width, height, format, pixels);
+	return true;
+}
+
+unsigned char* Texture::loadPixels(const char* filename, unsigned int* width, unsigned int* height, Format* format) {
+
+	int x = 0, y = 0, comp = 0;
+	unsigned char* pixels = stbi_load(filename, &x, &y, &comp, STBI_default);
+	if (pixels == nullptr)
+		return nullptr;
+
+	// stb's component counts line up with our formats
+	*width = (unsigned int)x;
+	*height = (unsigned int)y;
+	*format = (Format)comp;
+	return pixels;
+}
+
+void Texture::freePixels(unsigned char* pixels) {
+	stbi_image_free(pixels);
+}
+
+void Texture::upload(const char* filename, unsigned int width, unsigned int height, Format format, unsigned char* pixels) {
+
 	if (m_glHandle != 0) {
 		glDeleteTextures(1, &m_glHandle);
 		m_glHandle = 0;
-		m_width = 0;
-		m_height = 0;
-		m_filename = "none";
 	}
+	if (m_loadedPixels != nullptr)
+		stbi_image_free(m_loadedPixels);
 
-	int x = 0, y = 0, comp = 0;
-	m_loadedPixels = stbi_load(filename, &x, &y, &comp, STBI_default);
-
-	if (m_loadedPixels != nullptr) {
-		glGenTextures(1, &m_glHandle);
-		glBindTexture(GL_TEXTURE_2D, m_glHandle);
-		switch (comp) {
-		case STBI_grey:
-			m_format = RED;
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, x, y,
-						 0, GL_RED, GL_UNSIGNED_BYTE, m_loadedPixels);
-			break;
-		case STBI_grey_alpha:
-			m_format = RG;
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RG, x, y,
-						 0, GL_RG, GL_UNSIGNED_BYTE, m_loadedPixels);
-			break;
-		case STBI_rgb:
-			m_format = RGB;
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, x, y,
-						 0, GL_RGB, GL_UNSIGNED_BYTE, m_loadedPixels);
-			break;
-		case STBI_rgb_alpha:
-			m_format = RGBA;
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, x, y,
-						 0, GL_RGBA, GL_UNSIGNED_BYTE, m_loadedPixels);
-			break;
-		default:	break;
-		};
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glGenerateMipmap(GL_TEXTURE_2D);
-		glBindTexture(GL_TEXTURE_2D, 0);
-		m_width = (unsigned int)x;
-		m_height = (unsigned int)y;
-		m_filename = filename;
-		return true;
-	}
-	return false;
+	m_loadedPixels = pixels;
+	m_format = format;
+
+	glGenTextures(1, &m_glHandle);
+	glBindTexture(GL_TEXTURE_2D, m_glHandle);
+	switch (m_format) {
+	case RED:
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, width, height,
+					 0, GL_RED, GL_UNSIGNED_BYTE, m_loadedPixels);
+		break;
+	case RG:
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RG, width, height,
+					 0, GL_RG, GL_UNSIGNED_BYTE, m_loadedPixels);
+		break;
+	case RGB:
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height,
+					 0, GL_RGB, GL_UNSIGNED_BYTE, m_loadedPixels);
+		break;
+	case RGBA:
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height,
+					 0, GL_RGBA, GL_UNSIGNED_BYTE, m_loadedPixels);
+		break;
+	default:	break;
+	};
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	m_width = width;
+	m_height = height;
+	m_filename = filename;
 }
 
 void Texture::create(unsigned int width, unsigned int height, Format format, unsigned char* pixels) {
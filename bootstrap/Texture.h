@@ -23,6 +23,17 @@ public:
 	// load a jpg, bmp, png or tga
 	bool load(const char* filename);
 
+	// decodes a jpg, bmp, png or tga without making an opengl texture, so it
+	// can be called from any thread
+	// returns nullptr if it can't be loaded, otherwise the pixels belong to
+	// the caller until they're given to upload or freePixels
+	static unsigned char* loadPixels(const char* filename, unsigned int* width, unsigned int* height, Format* format);
+	static void freePixels(unsigned char* pixels);
+
+	// makes the opengl texture from pixels given by loadPixels, the same way
+	// load does, and takes ownership of the pixels
+	void upload(const char* filename, unsigned int width, unsigned int height, Format format, unsigned char* pixels);
+
 	// creates a texture that can be filled in with pixels
 	void create(unsigned int width, unsigned int height, Format format, unsigned char* pixels = nullptr);
 
@@ -0,0 +1,514 @@
+#include "benchmark.h"
+
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <fstream>
+
+#include "Profiler.h"
+#include "JobSystem.h"
+
+#include "darray.h"
+#include "tilegrid.h"
+#include "building.h"
+#include "simulation.h"
+#include "roadmanager.h"
+#include "savemanager.h"
+#include "buildingmanager.h"
+#include "pollutionmanager.h"
+
+// every allocation made through new goes through here so benchmarks can
+//   see how many they made
+// only in the citysim_benchmark build (see benchmark/CMakeLists.txt), so
+//   the game itself doesn't pay for counting every allocation
+static std::atomic<unsigned long long> s_allocCount(0);
+
+#ifdef BENCHMARK_BUILD
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+static void* countedAlloc(size_t size)
+{
+	s_allocCount++;
+	return malloc(size > 0 ? size : 1);
+}
+
+static void* countedAlignedAlloc(size_t size, std::align_val_t align)
+{
+	s_allocCount++;
+	size_t alignment = (size_t)align;
+	if (size == 0)
+		size = 1;
+#ifdef _MSC_VER
+	return _aligned_malloc(size, alignment);
+#else
+	// aligned_alloc wants the size to be a multiple of the alignment
+	size = (size + alignment - 1) / alignment * alignment;
+	return aligned_alloc(alignment, size);
+#endif
+}
+
+static void alignedFree(void* p)
+{
+#ifdef _MSC_VER
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+void* operator new(size_t size)
+{
+	void* p = countedAlloc(size);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAlloc(size);
+}
+
+void* operator new(size_t size, std::align_val_t align)
+{
+	void* p = countedAlignedAlloc(size, align);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void* operator new[](size_t size, std::align_val_t align)
+{
+	return operator new(size, align);
+}
+
+void* operator new(size_t size, std::align_val_t align,
+	const std::nothrow_t&) noexcept
+{
+	return countedAlignedAlloc(size, align);
+}
+
+void* operator new[](size_t size, std::align_val_t align,
+	const std::nothrow_t&) noexcept
+{
+	return countedAlignedAlloc(size, align);
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+	alignedFree(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+	alignedFree(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+	alignedFree(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept
+{
+	alignedFree(p);
+}
+
+void operator delete(void* p, std::align_val_t,
+	const std::nothrow_t&) noexcept
+{
+	alignedFree(p);
+}
+
+void operator delete[](void* p, std::align_val_t,
+	const std::nothrow_t&) noexcept
+{
+	alignedFree(p);
+}
+
+#endif // BENCHMARK_BUILD
+
+struct BenchmarkResult
+{
+	std::string	name;
+	double		nsPerOp;
+	// less than 0 if allocations aren't being counted
+	double		allocsPerOp;
+};
+
+typedef std::vector<BenchmarkResult> BenchmarkResults;
+
+//------------------------------------------------------------------------
+// Runs func once and records how long each of its operations took
+//
+// Param:
+//			results: where to add the result
+//			name:    what's being measured
+//			ops:     how many operations func does
+//			func:    the code to time
+//------------------------------------------------------------------------
+template <typename F>
+static void measure(BenchmarkResults& results, const std::string& name,
+	int ops, F func)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	unsigned long long allocsBefore = s_allocCount;
+	auto start = Clock::now();
+
+	func();
+
+	auto end = Clock::now();
+	unsigned long long allocs = s_allocCount - allocsBefore;
+
+	double ns = (double)std::chrono::duration_cast<
+		std::chrono::nanoseconds>(end - start).count();
+
+	BenchmarkResult result;
+	result.name = name;
+	result.nsPerOp = ns / ops;
+#ifdef BENCHMARK_BUILD
+	result.allocsPerOp = (double)allocs / ops;
+	printf("  %-48s %14.1f ns/op %10.2f allocs/op\n", name.c_str(),
+		result.nsPerOp, result.allocsPerOp);
+#else
+	result.allocsPerOp = -1.0;
+	(void)allocs;
+	printf("  %-48s %14.1f ns/op %10s allocs/op\n", name.c_str(),
+		result.nsPerOp, "-");
+#endif
+	results.push_back(result);
+}
+
+//------------------------------------------------------------------------
+// Records how long a profiler zone took per operation, out of everything
+//   recorded since the profiler was last cleared
+// Used to split up something that's been measured into its parts, so the
+//   allocations aren't known
+//
+// Param:
+//			results: where to add the result
+//			name:    what's being measured
+//			zone:    the name the zone was recorded with
+//			ops:     how many operations the zone was recorded over
+//------------------------------------------------------------------------
+static void measureZone(BenchmarkResults& results, const std::string& name,
+	const char* zone, int ops)
+{
+#if AIE_PROFILE
+	BenchmarkResult result;
+	result.name = name;
+	result.nsPerOp = (double)aie::Profiler::getTotalTime(zone) / ops;
+	result.allocsPerOp = -1.0;
+	printf("  %-48s %14.1f ns/op %10s allocs/op\n", name.c_str(),
+		result.nsPerOp, "-");
+	results.push_back(result);
+#else
+	// nothing was recorded to split it up with
+	(void)results;
+	(void)name;
+	(void)zone;
+	(void)ops;
+#endif
+}
+
+// the save files are loaded through the simulation, like the game does
+static bool benchmarkFixture(BenchmarkResults& results, const char* fixture)
+{
+	Simulation* sim = new Simulation();
+	SaveManager* saveManager = sim->getSaveManager();
+	BuildingManager* buildingManager = sim->getBuildingManager();
+	RoadManager* roadManager = sim->getRoadManager();
+
+	// same seed every time so growth does the same thing each run
+	sim->setSeed(1);
+
+	// printing isn't what's being timed, and the fixture's size is printed
+	//   below anyway
+	saveManager->setQuiet(true);
+	saveManager->setFileName(fixture);
+	if (!saveManager->loadData())
+	{
+		printf("Couldn't load benchmark fixture %s!\n", fixture);
+		delete sim;
+		return false;
+	}
+
+	int worldWidth = sim->getWorldWidth();
+	int worldHeight = sim->getWorldHeight();
+	printf("\n%s: %dx%d tiles, %d buildings\n", fixture, worldWidth,
+		worldHeight, buildingManager->getBuildings()->getCount());
+
+	std::string prefix = std::string(fixture) + " ";
+
+	// a load before timing means the file is cached and the world's
+	//   already the right size
+	saveManager->loadData();
+	measure(results, prefix + "SaveManager::loadData", 10, [&]()
+	{
+		for (int i = 0; i < 10; ++i)
+			saveManager->loadData();
+	});
+
+	// the first save creates the file, so it's left out too
+	saveManager->setFileName(BENCHMARK_SAVEFILE_NAME);
+	saveManager->saveData();
+	measure(results, prefix + "SaveManager::saveData", 10, [&]()
+	{
+		for (int i = 0; i < 10; ++i)
+			saveManager->saveData();
+	});
+	remove(BENCHMARK_SAVEFILE_NAME);
+	saveManager->setFileName(fixture);
+
+	measure(results, prefix + "BuildingManager::sortBuildings", 100, [&]()
+	{
+		for (int i = 0; i < 100; ++i)
+			buildingManager->sortBuildings();
+	});
+
+	measure(results, prefix + "RoadManager::updateRoads", 100, [&]()
+	{
+		for (int i = 0; i < 100; ++i)
+			roadManager->updateRoads();
+	});
+
+	// look at every tile, so both hits and misses are counted
+	int tileCount = worldWidth * worldHeight;
+	int found = 0;
+	measure(results, prefix + "RoadManager::getRoadAtPosition", tileCount,
+		[&]()
+	{
+		for (int y = 0; y < worldHeight; ++y)
+		{
+			for (int x = 0; x < worldWidth; ++x)
+			{
+				if (roadManager->getRoadAtPosition(x, y))
+					found++;
+			}
+		}
+	});
+
+	int totalDist = 0;
+	measure(results, prefix + "RoadManager::getClosestRoad", tileCount,
+		[&]()
+	{
+		for (int y = 0; y < worldHeight; ++y)
+		{
+			for (int x = 0; x < worldWidth; ++x)
+			{
+				int dist = 0;
+				if (roadManager->getClosestRoad(x, y, &dist))
+					totalDist += dist;
+			}
+		}
+	});
+
+	// a minute of game time, which covers plenty of power and growth ticks
+	const int ticks = SIM_TICK_RATE * 60;
+	measure(results, prefix + "BuildingManager::updateBuildings", ticks,
+		[&]()
+	{
+		for (int i = 0; i < ticks; ++i)
+			buildingManager->updateBuildings(sim->getTickTime());
+	});
+
+	// print these so the lookups can't be optimised away
+	printf("  (%d roads found, %d total road distance, %d buildings after growth)\n",
+		found, totalDist, buildingManager->getBuildings()->getCount());
+
+	delete sim;
+	return true;
+}
+
+// zone growth on a big generated world, where it has the most tiles to go
+//   through, then pollution spreading over all the factories that grew
+static void benchmarkGrowth(BenchmarkResults& results)
+{
+	const int size = BENCHMARK_GROWTH_WORLD_SIZE;
+	printf("\n%dx%d generated world\n", size, size);
+
+	Simulation* sim = new Simulation(nullptr, size, size);
+	BuildingManager* buildingManager = sim->getBuildingManager();
+	TileGrid* tiles = sim->getTiles();
+
+	sim->setSeed(1);
+
+	// bands of each zone with a road down every 8th column, and power
+	//   given straight to every tile so only growth is being timed
+	for (int x = 0; x < size; ++x)
+	{
+		if (x % 8 == 0)
+		{
+			for (int y = 0; y < size; ++y)
+			{
+				Building* road = buildingManager->makeBuilding(
+					BUILDINGTYPE_ROAD, x, y);
+				buildingManager->addBuilding(road, false);
+			}
+			continue;
+		}
+
+		for (int y = 0; y < size; ++y)
+		{
+			int zone = ZONETYPE_RESIDENTIAL + (y / 8) % 3;
+			tiles->setZoneType(x, y, (ZoneType)zone);
+			tiles->addPower(x, y);
+		}
+	}
+	buildingManager->sortBuildings();
+
+	// a full update timer's worth each time, so every call grows
+	const int ticks = 20;
+	std::string name = "BuildingManager::updateBuildings (growth)";
+	aie::Profiler::clear();
+	measure(results, name, ticks, [&]()
+	{
+		for (int i = 0; i < ticks; ++i)
+			buildingManager->updateBuildings(HOUSE_UPDATE_TIME);
+	});
+
+	// the same ticks split into the candidate scan, which is spread over
+	//   every thread, and the commit, which has to grow buildings in order
+	//   and only links their power as jobs
+	measureZone(results, "growth candidate scan (parallel)",
+		"BuildingManager growth candidates", ticks);
+	measureZone(results, "growth commit (in order)",
+		"BuildingManager growth commit", ticks);
+	measureZone(results, "growth commit power links (parallel)",
+		"PowerManager::linkNodes", ticks);
+
+	printf("  (%d buildings after growth)\n",
+		buildingManager->getBuildings()->getCount());
+
+	PollutionManager* pollutionManager = sim->getPollutionManager();
+	const int steps = 100;
+	measure(results, "PollutionManager::step", steps, [&]()
+	{
+		for (int i = 0; i < steps; ++i)
+			pollutionManager->step();
+	});
+
+	delete sim;
+}
+
+static void benchmarkDArray(BenchmarkResults& results)
+{
+	printf("\nDArray\n");
+
+	// same kind of list as BuildingList, the contents don't matter
+	const int count = 1000000;
+	BuildingList* list = new BuildingList();
+
+	measure(results, "DArray::add", count, [&]()
+	{
+		for (int i = 0; i < count; ++i)
+			list->add(nullptr);
+	});
+
+	measure(results, "DArray::remove (back)", count, [&]()
+	{
+		for (int i = count - 1; i >= 0; --i)
+			list->remove(i);
+	});
+
+	// removing from the front shuffles everything after it down
+	const int frontCount = 10000;
+	for (int i = 0; i < frontCount; ++i)
+		list->add(nullptr);
+	measure(results, "DArray::remove (front)", frontCount, [&]()
+	{
+		for (int i = 0; i < frontCount; ++i)
+			list->remove(0);
+	});
+
+	delete list;
+}
+
+int runBenchmarks(const char* csvFileName)
+{
+	aie::JobSystem::create();
+
+	BenchmarkResults results;
+	bool loadedAll = true;
+
+	const char* fixtures[] = BENCHMARK_FIXTURES;
+	for (auto fixture : fixtures)
+		loadedAll &= benchmarkFixture(results, fixture);
+
+	benchmarkGrowth(results);
+	benchmarkDArray(results);
+
+	if (csvFileName)
+	{
+		std::fstream file;
+		file.open(csvFileName, std::ios::out);
+		if (file.is_open())
+		{
+			file << "name,ns_per_op,allocs_per_op\n";
+			for (auto& result : results)
+			{
+				// allocations are left empty when they weren't counted
+				file << result.name << "," << result.nsPerOp << ",";
+				if (result.allocsPerOp >= 0.0)
+					file << result.allocsPerOp;
+				file << "\n";
+			}
+		}
+		else
+		{
+			printf("Couldn't open %s to write the results to!\n", csvFileName);
+		}
+	}
+
+	aie::JobSystem::destroy();
+
+	return loadedAll ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+// save files the benchmarks are run on, found in the bin folder
+#define BENCHMARK_FIXTURES { "city.wld", "testcity.wld", "fullcity.wld" }
+// where save benchmarks write to, deleted afterwards
+#define BENCHMARK_SAVEFILE_NAME "benchmark.wld"
+// tiles along each side of the world zone growth is benchmarked on
+#define BENCHMARK_GROWTH_WORLD_SIZE 512
+
+//------------------------------------------------------------------------
+// Times the simulation's hot paths on each of the fixture saves, without
+//   a window, and prints how long each operation took and how many
+//   allocations it made
+// Allocations are only counted when BENCHMARK_BUILD is defined, which
+//   citysim_benchmark is built with
+// used like: Project2D.exe -benchmark [results.csv]
+//   or citysim_benchmark [results.csv] when built from benchmark/
+//
+// Param:
+//			csvFileName: file to also write the results to, so they can be
+//						 compared between runs, or nullptr to only print
+// Return:
+//			0 on success, 1 if a fixture couldn't be loaded
+//------------------------------------------------------------------------
+int runBenchmarks(const char* csvFileName);
\ No newline at end of file
@@ -1,12 +1,15 @@
 #include "building.h"
 
-#include "game.h"
-#include "tile.h"
+#include <cmath>
+#include <climits>
+
+#include "tilegrid.h"
+#include "simulation.h"
 #include "tilemanager.h"
 #include "imagemanager.h"
 #include "buildingmanager.h"
 
-char* Building::buildingNames[BUILDINGTYPE_COUNT] = {
+const char* Building::buildingNames[BUILDINGTYPE_COUNT] = {
 	"None",
 	"Power Plant",
 	"Power Pole",
@@ -16,16 +19,17 @@ char* Building::buildingNames[BUILDINGTYPE_COUNT] = {
 	"Factory"
 };
 
-Building::Building(Game* game, int x, int y)
-	: m_game(game), m_posX(x), m_posY(y)
+Building::Building(Simulation* sim, int x, int y)
+	: m_sim(sim), m_posX(x), m_posY(y)
 {
 	// default values
-	m_texture = m_game->getImageManager()->getTexture("buildings/house");
+	m_sprite = m_sim->getImageManager()->getSprite(SPRITE_HOUSE);
 	m_type = BUILDINGTYPE_NONE;
 	m_sizeX = 1;
 	m_sizeY = 1;
 	m_buildStyle = BUILDSTYLE_SINGLE;
 	m_hasPower = false;
+	m_powerNode = -1;
 	m_powerSpreadRange = 2;
 	m_powerSearchRange = 1;
 	m_producesPower = false;
@@ -34,13 +38,14 @@ Building::Building(Game* game, int x, int y)
 	m_fallSpeed = 20000.0f;
 
 	m_tileAffectRange = 0;
+	m_depthKey = 0;
 
 	// default price is too expensive to buy
 	m_price = INT_MAX;
 
 	// grab the world position
 	m_worldPos =
-		m_game->getTileManager()->getTileWorldPosition(m_posX + 1, m_posY);
+		m_sim->getTileManager()->getTileWorldPosition(m_posX + 1, m_posY);
 }
 
 void Building::update(float delta)
@@ -56,23 +61,23 @@ void Building::update(float delta)
 			m_altitude = 0;
 
 			if (m_shakesCamera)
-				m_game->doScreenShake((float)m_sizeX * m_sizeY);
+				m_sim->doScreenShake((float)m_sizeX * m_sizeY);
 
 			// smokey particles on the front-left side
 			for (int i = m_posX + 1; i > m_posX - m_sizeX; --i)
 			{
 				const int y = m_posY + 1;
 				Vector2 v =
-					m_game->getTileManager()->getTileWorldPosition(i, y);
-				m_game->spawnSmokeParticle(v);
+					m_sim->getTileManager()->getTileWorldPosition(i, y);
+				m_sim->spawnSmokeParticle(v);
 			}
 			// and front-right side
 			for (int i = m_posY + 1; i >= m_posY - m_sizeY; --i)
 			{
 				const int x = m_posX + 1;
 				Vector2 v =
-					m_game->getTileManager()->getTileWorldPosition(x, i);
-				m_game->spawnSmokeParticle(v);
+					m_sim->getTileManager()->getTileWorldPosition(x, i);
+				m_sim->spawnSmokeParticle(v);
 			}
 		}
 	}
@@ -102,30 +107,30 @@ void Building::affectOrUnaffectTiles(bool affect)
 	int maxX = m_posX + m_tileAffectRange;
 	int maxY = m_posY + m_tileAffectRange;
 
+	TileGrid* tiles = m_sim->getTiles();
 	for (int y = minY; y <= maxY; ++y)
 	{
 		for (int x = minX; x <= maxX; ++x)
 		{
-			if (!m_game->getTileManager()->isIndexInBounds(x, y))
+			if (!tiles->isInBounds(x, y))
 				continue;
-			Tile* t = m_game->getTileManager()->getTile(x, y);
 			if (affect)
-				this->affectTile(t);
+				this->affectTile(tiles, x, y);
 			else
-				this->unaffectTile(t);
+				this->unaffectTile(tiles, x, y);
 		}
 	}
 }
 
 // do nothing by default
-void Building::affectTile(Tile* t) {}
-void Building::unaffectTile(Tile* t) {}
+void Building::affectTile(TileGrid* tiles, int x, int y) {}
+void Building::unaffectTile(TileGrid* tiles, int x, int y) {}
 
-void Building::drawEyeball(aie::Renderer2D* renderer, Vector2& pos,
+void Building::drawEyeball(aie::Renderer2D* renderer, const Vector2& pos,
 	const float rad) const
 {
 	// get mouse position
-	Vector2 mousePos = m_game->getMouseWorldPosition();
+	Vector2 mousePos = m_sim->getMouseWorldPosition();
 
 	// get angle to mouse
 	mousePos -= pos;
@@ -156,7 +161,7 @@ void Building::setPosition(int x, int y)
 
 	// update world positions
 	m_worldPos =
-		m_game->getTileManager()->getTileWorldPosition(m_posX + 1, m_posY);
+		m_sim->getTileManager()->getTileWorldPosition(m_posX + 1, m_posY);
 }
 
 void Building::getCenter(int* x, int* y) const
@@ -165,73 +170,25 @@ void Building::getCenter(int* x, int* y) const
 	*y = m_posY - (m_sizeY - 1) / 2;
 }
 
-// checks if this building should have power and also spreads it if needed
-bool Building::updatePower()
+void Building::updateDepthKey()
 {
-	TileManager* tMan = m_game->getTileManager();
-
-	// check if a tile of ours has power
-	int maxX = m_posX + m_powerSearchRange;
-	int maxY = m_posY + m_powerSearchRange;
-	int minX = m_posX - (m_sizeX - 1) - m_powerSearchRange;
-	int minY = m_posY - (m_sizeY - 1) - m_powerSearchRange;
-
-	m_hasPower = m_producesPower;
-	if (!m_hasPower)
-	{
-		// if we have no power, search for it!
-		for (int y = minY; y <= maxY; ++y)
-		{
-			for (int x = minX; x <= maxX; ++x)
-			{
-				if (x < 0 || y < 0 || x >= WORLD_WIDTH || y >= WORLD_HEIGHT)
-					continue;
-
-				Tile* thisTile = tMan->getTile(x, y);
-				if (!thisTile)
-					continue;
-				if (thisTile->hasPower())
-				{
-					m_hasPower = true;
-					break;
-				}
-			}
-			if (m_hasPower)
-				break;
-		}
-	}
-
-	// don't continue with this if this building has no power
-	if (!m_hasPower)
-		return false;
-
-	// make values larger for spreading power
-	maxX = m_posX + m_powerSpreadRange;
-	maxY = m_posY + m_powerSpreadRange;
-	minX = m_posX - (m_sizeX - 1) - m_powerSpreadRange;
-	minY = m_posY - (m_sizeY - 1) - m_powerSpreadRange;
-
-	// we want to return true if this changed the state of the power
-	bool gavePower = false;
-
-	// pass power on to the next few tiles
-	for (int y = minY; y <= maxY; ++y)
-	{
-		for (int x = minX; x <= maxX; ++x)
-		{
-			if (tMan->isIndexInBounds(x, y))
-				continue;
-
-			Tile* thisTile = tMan->getTile(x, y);
-			if (!thisTile)
-				continue;
-			if (!thisTile->hasPower())
-			{
-				gavePower = true;
-				thisTile->setPower(true);
-			}
-		}
-	}
+	int centerX, centerY;
+	getCenter(&centerX, &centerY);
+	if (centerX < 0) centerX = 0;
+	if (centerY < 0) centerY = 0;
+
+	// tiles further down the screen have a bigger x + y, so that goes in the
+	//   high bits, and x breaks ties so the order is always the same
+	m_depthKey = ((unsigned int)(centerX + centerY) << 16)
+		| ((unsigned int)centerX & 0xFFFF);
+}
 
-	return gavePower;
+// grabs the bounds of the building, grown by range tiles on each side
+void Building::getPowerBounds(const int range, int* minX, int* minY,
+	int* maxX, int* maxY) const
+{
+	*minX = m_posX - (m_sizeX - 1) - range;
+	*minY = m_posY - (m_sizeY - 1) - range;
+	*maxX = m_posX + range;
+	*maxY = m_posY + range;
 }
@@ -29,19 +29,20 @@ enum BuildStyle
 };
 
 // Forward declares
-class Game;
-class Tile;
+class Simulation;
+class TileGrid;
+struct Sprite;
 
 class Building
 {
 public:
 	//------------------------------------------------------------------------
 	// Param:
-	//			game: pointer to our Game so we can access everything we need
+	//			sim:  pointer to our Simulation so we can access everything
 	//			x:    tile-based x position of the building
 	//			y:    tile-based y position of the building
 	//------------------------------------------------------------------------
-	Building(Game* game, int x, int y);
+	Building(Simulation* sim, int x, int y);
 
 	virtual ~Building() = default;
 
@@ -78,7 +79,8 @@ public:
 	//			pos:      center point of the eye
 	//			rad:      radius of the eye
 	//------------------------------------------------------------------------
-	void drawEyeball(aie::Renderer2D* renderer, Vector2& pos, float rad) const;
+	void drawEyeball(aie::Renderer2D* renderer, const Vector2& pos,
+		float rad) const;
 
 	//------------------------------------------------------------------------
 	// Sets the position of the building, represented as the index of the tile
@@ -110,6 +112,20 @@ public:
 	//------------------------------------------------------------------------
 	void getCenter(int* x, int* y) const;
 	//------------------------------------------------------------------------
+	// Works out the depth key from the building's current center
+	// Called when the building is added to the world, since the size isn't
+	// known until the derived constructor has run
+	//------------------------------------------------------------------------
+	void updateDepthKey();
+	//------------------------------------------------------------------------
+	// Gets the key used to sort buildings into draw order
+	// Buildings with smaller keys are further back, so are drawn first
+	//
+	// Return: 
+	//			the depth key worked out by the last updateDepthKey
+	//------------------------------------------------------------------------
+	unsigned int getDepthKey() const { return m_depthKey; }
+	//------------------------------------------------------------------------
 	// Gets the size (in tiles) of the building
 	//
 	// Param: 
@@ -123,7 +139,7 @@ public:
 	// Param: 
 	//			tex: the new texture
 	//------------------------------------------------------------------------
-	void setTexture(aie::Texture* tex) { m_texture = tex; }
+	void setSprite(Sprite* sprite) { m_sprite = sprite; }
 	//------------------------------------------------------------------------
 	// Gets the world position of the building, as opposed to the tile-based
 	// positions stored in m_posX and m_posY
@@ -151,9 +167,41 @@ public:
 	void setFallSpeed(const float spd) { m_fallSpeed = spd; }
 
 	//------------------------------------------------------------------------
-	// Powers this building if available, and spreads power if power is found
+	// Gets whether or not this building is powered
+	// Power is worked out by the PowerManager
+	//
+	// Return: 
+	//			whether or not the building has power
+	//------------------------------------------------------------------------
+	bool hasPower() const { return m_hasPower; }
+	//------------------------------------------------------------------------
+	// Changes the power state of the building
+	//
+	// Param: 
+	//			p: new power state
+	//------------------------------------------------------------------------
+	void setPower(const bool p) { m_hasPower = p; }
+	//------------------------------------------------------------------------
+	// Gets whether or not this building makes its own power
+	//
+	// Return: 
+	//			whether or not the building produces power
 	//------------------------------------------------------------------------
-	bool updatePower();
+	bool producesPower() const { return m_producesPower; }
+	//------------------------------------------------------------------------
+	// Gets the tile bounds of the building grown by a number of tiles on
+	// each side
+	// Used with the power search/spread ranges to find the affected tiles
+	//
+	// Param: 
+	//			range: how many tiles to grow the bounds by on each side
+	//			minX:  pointer to where the left bound will be stored
+	//			minY:  pointer to where the top bound will be stored
+	//			maxX:  pointer to where the right bound will be stored
+	//			maxY:  pointer to where the bottom bound will be stored
+	//------------------------------------------------------------------------
+	void getPowerBounds(int range, int* minX, int* minY, 
+		int* maxX, int* maxY) const;
 	//------------------------------------------------------------------------
 	// Gets how many tiles to search when looking for power
 	//
@@ -168,6 +216,21 @@ public:
 	//			number of tiles from each side to spread
 	//------------------------------------------------------------------------
 	int getPowerSpread() const { return m_powerSpreadRange; }
+	//------------------------------------------------------------------------
+	// Gets where the PowerManager keeps this building's place in the grid
+	//
+	// Return: 
+	//			index of the building's power node, -1 if it isn't in the grid
+	//------------------------------------------------------------------------
+	int getPowerNode() const { return m_powerNode; }
+	//------------------------------------------------------------------------
+	// Sets where the PowerManager keeps this building's place in the grid
+	// Only the PowerManager should call this
+	//
+	// Param: 
+	//			node: index of the building's power node, -1 for none
+	//------------------------------------------------------------------------
+	void setPowerNode(const int node) { m_powerNode = node; }
 
 	//------------------------------------------------------------------------
 	// Gets the kind of building this is
@@ -194,14 +257,16 @@ public:
 	int getPrice() const { return m_price; }
 
 	// a static array of names to show in the UI
-	static char* buildingNames[BUILDINGTYPE_COUNT];
+	static const char* buildingNames[BUILDINGTYPE_COUNT];
 protected:
-	Game*			m_game;
+	Simulation*			m_sim;
 
 	// positioning information
 	int				m_posX, m_posY;
 	int				m_sizeX, m_sizeY;
 	Vector2			m_worldPos;
+	// center's distance back into the screen, used for draw order
+	unsigned int	m_depthKey;
 
 	// used for dropping it into the world
 	float			m_altitude;
@@ -216,6 +281,8 @@ protected:
 	bool			m_producesPower;
 	// whether or not this building is powered
 	bool			m_hasPower;
+	// the building's node in the PowerManager, -1 if it isn't in the grid
+	int				m_powerNode;
 
 	// how long of a reach does affectTile have
 	int				m_tileAffectRange;
@@ -227,12 +294,12 @@ protected:
 	BuildingType	m_type;
 	// how the player places this building
 	BuildStyle		m_buildStyle;
-	// the texture to draw
-	aie::Texture*	m_texture;
+	// the picture to draw
+	Sprite*			m_sprite;
 
 	// these are used to more efficiently affect surrounding tiles' values
 	//   when created/destroyed
 	void affectOrUnaffectTiles(bool affect);
-	virtual void affectTile(Tile* t);
-	virtual void unaffectTile(Tile* t);
+	virtual void affectTile(TileGrid* tiles, int x, int y);
+	virtual void unaffectTile(TileGrid* tiles, int x, int y);
 };
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "buildingindex.h"
+
+#include <algorithm>
+
+BuildingIndex::BuildingIndex()
+{
+	m_chunksWide = 0;
+	m_chunksHigh = 0;
+	m_maxSizeX = 1;
+	m_maxSizeY = 1;
+}
+
+void BuildingIndex::resize(int worldWidth, int worldHeight)
+{
+	// round up so the edges of the world still get a chunk
+	m_chunksWide = (worldWidth + BUILDING_CHUNK_SIZE - 1) / BUILDING_CHUNK_SIZE;
+	m_chunksHigh = (worldHeight + BUILDING_CHUNK_SIZE - 1) / BUILDING_CHUNK_SIZE;
+
+	m_chunks.clear();
+	m_chunks.resize(m_chunksWide * m_chunksHigh);
+	clear();
+}
+
+void BuildingIndex::clear()
+{
+	for (auto& c : m_chunks)
+	{
+		c.buildings.clear();
+		for (int i = 0; i < BUILDINGTYPE_COUNT; ++i)
+			c.typeCounts[i] = 0;
+	}
+
+	m_maxSizeX = 1;
+	m_maxSizeY = 1;
+}
+
+void BuildingIndex::addBuilding(Building* build)
+{
+	Chunk* chunk = getChunkFor(build);
+	if (!chunk)
+		return;
+
+	chunk->buildings.push_back(build);
+	chunk->typeCounts[build->getType()]++;
+
+	int sizeX, sizeY;
+	build->getSize(&sizeX, &sizeY);
+	m_maxSizeX = std::max(m_maxSizeX, sizeX);
+	m_maxSizeY = std::max(m_maxSizeY, sizeY);
+}
+
+void BuildingIndex::addBuildings(const std::vector<Building*>& builds)
+{
+	// count how many go in each chunk first so they only grow once
+	std::vector<int> counts(m_chunks.size(), 0);
+	for (auto build : builds)
+	{
+		Chunk* chunk = getChunkFor(build);
+		if (chunk)
+			counts[chunk - m_chunks.data()]++;
+	}
+	for (size_t i = 0; i < m_chunks.size(); ++i)
+	{
+		if (counts[i] > 0)
+			m_chunks[i].buildings.reserve(m_chunks[i].buildings.size()
+				+ counts[i]);
+	}
+
+	for (auto build : builds)
+		addBuilding(build);
+}
+
+void BuildingIndex::removeBuilding(Building* build)
+{
+	Chunk* chunk = getChunkFor(build);
+	if (!chunk)
+		return;
+
+	std::vector<Building*>& buildings = chunk->buildings;
+	auto found = std::find(buildings.begin(), buildings.end(), build);
+	if (found == buildings.end())
+		return;
+
+	// order doesn't matter, so swap it to the back to avoid shuffling
+	*found = buildings.back();
+	buildings.pop_back();
+
+	chunk->typeCounts[build->getType()]--;
+}
+
+int BuildingIndex::getChunkCount(int chunkX, int chunkY,
+	BuildingType type) const
+{
+	if (chunkX < 0 || chunkY < 0
+		|| chunkX >= m_chunksWide || chunkY >= m_chunksHigh)
+		return 0;
+
+	return m_chunks[chunkY * m_chunksWide + chunkX].typeCounts[type];
+}
+
+void BuildingIndex::getBuildingsInRegion(int minX, int minY, int maxX,
+	int maxY, std::vector<Building*>& results) const
+{
+	// buildings stretch up and left from their root tile, so anything
+	//   rooted a bit past the bottom right could still reach in
+	int rootMaxX = maxX + m_maxSizeX - 1;
+	int rootMaxY = maxY + m_maxSizeY - 1;
+
+	int chunkMinX = std::max(minX / BUILDING_CHUNK_SIZE, 0);
+	int chunkMinY = std::max(minY / BUILDING_CHUNK_SIZE, 0);
+	int chunkMaxX = std::min(rootMaxX / BUILDING_CHUNK_SIZE, m_chunksWide - 1);
+	int chunkMaxY = std::min(rootMaxY / BUILDING_CHUNK_SIZE, m_chunksHigh - 1);
+
+	for (int cy = chunkMinY; cy <= chunkMaxY; ++cy)
+	{
+		for (int cx = chunkMinX; cx <= chunkMaxX; ++cx)
+		{
+			const Chunk& chunk = m_chunks[cy * m_chunksWide + cx];
+			for (auto b : chunk.buildings)
+			{
+				int posX, posY, sizeX, sizeY;
+				b->getPosition(&posX, &posY);
+				b->getSize(&sizeX, &sizeY);
+
+				// check the building's tiles actually overlap the region
+				if (posX < minX || posX - sizeX + 1 > maxX
+					|| posY < minY || posY - sizeY + 1 > maxY)
+					continue;
+
+				results.push_back(b);
+			}
+		}
+	}
+}
+
+void BuildingIndex::getBuildingsInRadius(int x, int y, int radius,
+	std::vector<Building*>& results) const
+{
+	getBuildingsInRegion(x - radius, y - radius, x + radius, y + radius,
+		results);
+}
+
+BuildingIndex::Chunk* BuildingIndex::getChunkFor(Building* build)
+{
+	int posX, posY;
+	build->getPosition(&posX, &posY);
+
+	int chunkX = posX / BUILDING_CHUNK_SIZE;
+	int chunkY = posY / BUILDING_CHUNK_SIZE;
+	if (posX < 0 || posY < 0
+		|| chunkX >= m_chunksWide || chunkY >= m_chunksHigh)
+		return nullptr;
+
+	return &m_chunks[chunkY * m_chunksWide + chunkX];
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <vector>
+
+#include "building.h" // for BUILDINGTYPE_COUNT enum
+
+// how many tiles across each chunk of the index is
+#define BUILDING_CHUNK_SIZE 16
+
+// keeps track of where buildings are by splitting the world up into chunks
+// every building is put in the chunk its root tile (its position) is in,
+//   and each chunk counts how many of each type it has
+// this means finding buildings near a spot only looks at a few chunks
+//   instead of every building, and counting buildings is instant
+class BuildingIndex
+{
+public:
+	BuildingIndex();
+
+	// we don't expect BuildingIndex to be copied/moved
+	BuildingIndex(const BuildingIndex& bi) = default;
+	BuildingIndex(BuildingIndex&& bi) = default;
+	BuildingIndex& operator=(BuildingIndex& bi) = default;
+	BuildingIndex& operator=(BuildingIndex&& bi) = default;
+
+	//------------------------------------------------------------------------
+	// Forgets every building and makes enough chunks to cover a world
+	//
+	// Param:
+	//			worldWidth:  how many tiles wide the world is
+	//			worldHeight: how many tiles tall the world is
+	//------------------------------------------------------------------------
+	void resize(int worldWidth, int worldHeight);
+	//------------------------------------------------------------------------
+	// Forgets every building without changing the size
+	//------------------------------------------------------------------------
+	void clear();
+
+	//------------------------------------------------------------------------
+	// Adds a building to the chunk it's in
+	// The building shouldn't move while it's in the index
+	//
+	// Param:
+	//			build: the building to add
+	//------------------------------------------------------------------------
+	void addBuilding(Building* build);
+	//------------------------------------------------------------------------
+	// Adds a whole batch of buildings, making room in each chunk for all
+	//   of its buildings at once
+	//
+	// Param:
+	//			builds: the buildings to add
+	//------------------------------------------------------------------------
+	void addBuildings(const std::vector<Building*>& builds);
+	//------------------------------------------------------------------------
+	// Takes a building out of the index
+	//
+	// Param:
+	//			build: the building to remove
+	//------------------------------------------------------------------------
+	void removeBuilding(Building* build);
+
+	//------------------------------------------------------------------------
+	// Gets how many buildings of a type have their root tile in a chunk
+	//
+	// Param:
+	//			chunkX: x index of the chunk
+	//			chunkY: y index of the chunk
+	//			type:   BuildingType to count
+	// Return:
+	//			how many buildings of the type are in the chunk, 0 if the
+	//			chunk doesn't exist
+	//------------------------------------------------------------------------
+	int getChunkCount(int chunkX, int chunkY, BuildingType type) const;
+
+	// how many chunks the index is split into
+	int getChunksWide() const { return m_chunksWide; }
+	int getChunksHigh() const { return m_chunksHigh; }
+
+	//------------------------------------------------------------------------
+	// Finds every building that covers at least one tile in a rectangle
+	// Buildings are added to the end of results, in no particular order
+	//
+	// Param:
+	//			minX:    left edge of the rectangle in tiles
+	//			minY:    top edge of the rectangle in tiles
+	//			maxX:    right edge of the rectangle in tiles, inclusive
+	//			maxY:    bottom edge of the rectangle in tiles, inclusive
+	//			results: where to put the buildings that were found
+	//------------------------------------------------------------------------
+	void getBuildingsInRegion(int minX, int minY, int maxX, int maxY,
+		std::vector<Building*>& results) const;
+	//------------------------------------------------------------------------
+	// Finds every building that covers a tile within a number of tiles of a
+	//   position, the same square reach buildings use for power and
+	//   pollution
+	// Buildings are added to the end of results, in no particular order
+	//
+	// Param:
+	//			x:       x index of the centre tile
+	//			y:       y index of the centre tile
+	//			radius:  how many tiles away from the centre to look
+	//			results: where to put the buildings that were found
+	//------------------------------------------------------------------------
+	void getBuildingsInRadius(int x, int y, int radius,
+		std::vector<Building*>& results) const;
+private:
+	struct Chunk
+	{
+		// every building with its root tile in this chunk
+		std::vector<Building*> buildings;
+		int typeCounts[BUILDINGTYPE_COUNT];
+	};
+
+	std::vector<Chunk> m_chunks;
+	int m_chunksWide, m_chunksHigh;
+
+	// the biggest building we've been given, so region searches know how
+	//   far outside the region a building's root tile could be
+	int m_maxSizeX, m_maxSizeY;
+
+	// gets the chunk a building belongs in, nullptr if it's off the map
+	Chunk* getChunkFor(Building* build);
+};
\ No newline at end of file
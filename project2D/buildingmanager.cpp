@@ -1,19 +1,27 @@
 #include "buildingmanager.h"
 
+#include <cmath>
 #include <chrono>
+#include <cstdio>
 #include <iostream>
 #include <algorithm>
 
 #include "Input.h"
+#include "Profiler.h"
+#include "JobSystem.h"
 
 #include "game.h"
-#include "tile.h"
 #include "darray.h"
 #include "random.h"
+#include "tilegrid.h"
 #include "building.h"
+#include "citystats.h"
 #include "uimanager.h"
+#include "simulation.h"
 #include "roadmanager.h"
 #include "tilemanager.h"
+#include "powermanager.h"
+#include "buildingindex.h"
 
 // building types
 #include "road.h"
@@ -23,17 +31,24 @@
 #include "powerpole.h"
 #include "powerplant.h"
 
-BuildingManager::BuildingManager(Game* game, BuildingList* buildings)
-	: m_game(game), m_buildings(buildings)
+// the tiles in one chunk of the map that could grow a building
+struct GrowthChunk
+{
+	// 1D indices of empty liveable zoned tiles, in a random order
+	std::vector<int> candidates;
+	// how many tiles in the chunk are zoned at all
+	int zonedCount = 0;
+};
+
+BuildingManager::BuildingManager(Simulation* sim, BuildingList* buildings)
+	: m_sim(sim), m_buildings(buildings)
 {
 	m_selectedBuilding = 0;
-	m_powerTimer = 0;
 	m_houseTimer = 0;
 	m_ghostBuilding = nullptr;
 
-	m_houseCount = 0;
-	m_shopCount = 0;
-	m_factoryCount = 0;
+	m_index = new BuildingIndex();
+	m_index->resize(m_sim->getWorldWidth(), m_sim->getWorldHeight());
 
 	m_dragging = false;
 	m_isDragHorizontal = false;
@@ -46,12 +61,13 @@ BuildingManager::BuildingManager(Game* game, BuildingList* buildings)
 BuildingManager::~BuildingManager()
 {
 	delete m_ghostBuilding;
+	delete m_index;
 }
 
 void BuildingManager::buildingMode()
 {
 	// double check to make sure we're in building mode
-	if (m_game->getPlaceMode() != PLACEMODE_BUILDING)
+	if (m_sim->getGame()->getPlaceMode() != PLACEMODE_BUILDING)
 		return;
 
 	aie::Input* input = aie::Input::getInstance();
@@ -59,7 +75,7 @@ void BuildingManager::buildingMode()
 	// B to toggle building mode
 	if (input->wasKeyPressed(aie::INPUT_KEY_B))
 	{
-		m_game->setPlaceMode(PLACEMODE_NONE);
+		m_sim->getGame()->setPlaceMode(PLACEMODE_NONE);
 		return;
 	}
 
@@ -76,11 +92,11 @@ void BuildingManager::buildingMode()
 		m_selectedBuilding = (int)BUILDINGTYPE_COUNT - 1;
 
 	// grab the mouse position
-	Vector2 mousePos = m_game->getMouseWorldPosition();
+	Vector2 mousePos = m_sim->getMouseWorldPosition();
 
 	// get the index of the tile we're mousing over
 	int tileX, tileY;
-	m_game->getTileManager()->getTileAtPosition(mousePos, &tileX, &tileY);
+	m_sim->getTileManager()->getTileAtPosition(mousePos, &tileX, &tileY);
 
 	// update the ghost building to show which building we're choosing
 	if (m_ghostBuilding == nullptr
@@ -98,7 +114,7 @@ void BuildingManager::buildingMode()
 	// demolish buildings
 	if (m_selectedBuilding == BUILDINGTYPE_NONE
 		&& input->isMouseButtonDown(aie::INPUT_MOUSE_BUTTON_LEFT)
-		&& m_game->isMouseInGame())
+		&& m_sim->getGame()->isMouseInGame())
 	{
 		Building* underMouse = getBuildingAtIndex(tileX, tileY);
 		if (underMouse)
@@ -113,7 +129,7 @@ void BuildingManager::buildingMode()
 		&& m_ghostBuilding->getBuildStyle() == BUILDSTYLE_LINE)
 	{
 		if (input->wasMouseButtonPressed(aie::INPUT_MOUSE_BUTTON_LEFT)
-			&& m_game->isMouseInGame() && tileX > -1 && tileY > -1)
+			&& m_sim->getGame()->isMouseInGame() && tileX > -1 && tileY > -1)
 		{
 			// dragging start
 			m_dragStartX = tileX;
@@ -177,11 +193,11 @@ void BuildingManager::buildingMode()
 		{
 			sortBuildings();
 			if (m_ghostBuilding->getType() == BUILDINGTYPE_ROAD)
-				m_game->getRoadManager()->updateRoads();
+				m_sim->getRoadManager()->updateRoads();
 		}
 	}
 
-	if (!(canPlaceBuilding() && m_game->isMouseInGame()))
+	if (!(canPlaceBuilding() && m_sim->getGame()->isMouseInGame()))
 		return;
 
 	if (input->wasMouseButtonPressed(aie::INPUT_MOUSE_BUTTON_LEFT)
@@ -216,7 +232,7 @@ void BuildingManager::drawPlacement(aie::Renderer2D* renderer) const
 			int bottom = posY + m_ghostBuilding->getPowerSearch();
 
 			renderer->setRenderColour(1, 1, 0, 0.2f);
-			m_game->drawTileRect(left, top, right, bottom);
+			m_sim->getGame()->drawTileRect(left, top, right, bottom);
 		}
 
 		const float alpha = 0.4f;
@@ -232,139 +248,128 @@ void BuildingManager::drawPlacement(aie::Renderer2D* renderer) const
 	if (m_dragging)
 	{
 		renderer->setRenderColour(1, 1, 1);
-		m_game->drawTileRect(m_dragStartX, m_dragStartY, m_dragPosX, m_dragPosY);
+		m_sim->getGame()->drawTileRect(m_dragStartX, m_dragStartY, m_dragPosX, m_dragPosY);
 	}
 }
 
 void BuildingManager::updateBuildings(float delta)
 {
-	// the regular update function deals with per-frame stuff
-	for (int i = 0; i < m_buildings->getCount(); ++i)
-		(*m_buildings)[i]->update(delta);
+	PROFILE_ZONE("BuildingManager::updateBuildings");
 
-	// update everything else that needs to be updated once
-	//   every so often
-	m_powerTimer += delta;
-	if (m_powerTimer >= POWER_UPDATE_TIME)
+	// the regular update function deals with per-frame stuff
 	{
-
-		m_game->getTileManager()->clearTilePower();
-		bool changedPower = true;
-		while (changedPower)
-		{
-			changedPower = false;
-			for (int i = 0; i < m_buildings->getCount(); ++i)
-			{
-				Building* b = (*m_buildings)[i];
-				bool temp = b->updatePower();
-				if (!changedPower)
-					changedPower = temp;
-			}
-		}
-
-		m_powerTimer = 0;
+		PROFILE_ZONE("Building::update");
+		for (int i = 0; i < m_buildings->getCount(); ++i)
+			(*m_buildings)[i]->update(delta);
 	}
 
+	// recalculate power for any networks that changed since last frame
+	m_sim->getPowerManager()->updatePower();
+
+	// update everything else that needs to be updated once
+	//   every so often
 	// update houses
 	m_houseTimer -= delta;
 	if (m_houseTimer <= 0)
 	{
-		int newBuildings = 0;
-
-		// grab a list of all tiles which could use buildings
-		std::vector<Tile*> zonedTiles;
-
-		for (int y = 0; y < WORLD_HEIGHT; ++y)
-		{
-			for (int x = 0; x < WORLD_WIDTH; ++x)
-			{
-				Tile* t = m_game->getTileManager()->getTile(x, y);
-				if (t->getZoneType() == ZONETYPE_NONE)
-					continue;
-				zonedTiles.push_back(t);
-			}
-		}
+		PROFILE_ZONE("BuildingManager growth");
 
-		// shuffle the tile list
-		for (int i = (int)zonedTiles.size() - 1; i > 0; --i)
-		{
-			int newIndex = rand() % (i + 1);
-			Tile* t = zonedTiles[newIndex];
-			zonedTiles[newIndex] = zonedTiles[i];
-			zonedTiles[i] = t;
-		}
+		TileGrid* tiles = m_sim->getTiles();
+		TileManager* tileManager = m_sim->getTileManager();
 
-		auto tileAmt = (int)zonedTiles.size();
+		// work out which tiles could grow a building, a chunk of the map at
+		//   a time as jobs, each chunk shuffling its own tiles from its own
+		//   seed so it doesn't matter which thread gets it
+		m_sim->getRoadManager()->updateRoadDistance();
 
+		const int chunksWide = (tiles->getWidth() + GROWTH_CHUNK_SIZE - 1)
+			/ GROWTH_CHUNK_SIZE;
+		const int chunksHigh = (tiles->getHeight() + GROWTH_CHUNK_SIZE - 1)
+			/ GROWTH_CHUNK_SIZE;
+		const int chunkCount = chunksWide * chunksHigh;
 
-		int processed = 0;
-		int toProcess = (tileAmt / 10) + 1;
+		Random& growthRandom = m_sim->getRandom(RANDOMSTREAM_GROWTH);
+		const unsigned int growthSeed = growthRandom.next();
 
-		for (auto t : zonedTiles)
+		std::vector<GrowthChunk> chunks(chunkCount);
 		{
-			if (processed >= toProcess)
-				break;
-
-			int xIndex, yIndex;
-			t->getIndices(&xIndex, &yIndex);
-
-			if (getBuildingAtIndex(xIndex, yIndex))
-				continue;
-
-			if (!t->isLiveable())
-				continue;
-
-			Building* newBuilding;
-
-			float resDemand = getResidentialDemand();
-			float comDemand = getCommercialDemand();
-			float indDemand = getIndustrialDemand();
+			PROFILE_ZONE("BuildingManager growth candidates");
+			aie::JobSystem::getInstance()->parallelFor(chunkCount, 1,
+				[&](int start, int end)
+			{
+				for (int chunk = start; chunk < end; ++chunk)
+				{
+					findGrowthCandidates(chunk, growthSeed, &chunks[chunk]);
+				}
+			});
+		}
 
-			const float minDemand = 1.0f;
+		{
+			PROFILE_ZONE("BuildingManager growth commit");
+
+			// only let a tenth of the zones grow each time
+			int zonedCount = 0;
+			for (auto& chunk : chunks)
+				zonedCount += chunk.zonedCount;
+			int toProcess = (zonedCount / 10) + 1;
+
+			// shuffle which order the chunks get a turn in
+			std::vector<int> chunkOrder(chunkCount);
+			for (int i = 0; i < chunkCount; ++i)
+				chunkOrder[i] = i;
+			for (int i = chunkCount - 1; i > 0; --i)
+			{
+				int swapWith = growthRandom.randBetween(0, i + 1);
+				std::swap(chunkOrder[i], chunkOrder[swapWith]);
+			}
 
-			switch (t->getZoneType())
+			// then build on one tile from each chunk in turn, so growth is spread
+			//   over the whole map instead of filling the first chunks up
+			// each building changes the demand for the next, so this part has
+			//   to go in order, but each chunk keeps what grew in it to be
+			//   linked into the power grid as a job afterwards
+			std::vector<std::vector<Building*>> grown(chunkCount);
+			int processed = 0;
+			bool tilesLeft = true;
+			for (int turn = 0; tilesLeft && processed < toProcess; ++turn)
 			{
-			case ZONETYPE_RESIDENTIAL:
-				if (resDemand < minDemand)
-					continue;
-				newBuilding = makeBuilding(BUILDINGTYPE_HOUSE,
-					xIndex, yIndex);
-				break;
-			case ZONETYPE_COMMERCIAL:
-				if (comDemand < minDemand)
-					continue;
-				newBuilding = makeBuilding(BUILDINGTYPE_SHOP,
-					xIndex, yIndex);
-				break;
-			case ZONETYPE_INDUSTRIAL:
-				if (indDemand < minDemand)
-					continue;
-				newBuilding = makeBuilding(BUILDINGTYPE_FACTORY,
-					xIndex, yIndex);
-				break;
-			case ZONETYPE_NONE:
-			case ZONETYPE_COUNT:
-			default:
-				continue;
+				tilesLeft = false;
+				for (int c : chunkOrder)
+				{
+					if (processed >= toProcess)
+						break;
+
+					const std::vector<int>& candidates = chunks[c].candidates;
+					if (turn >= (int)candidates.size())
+						continue;
+					tilesLeft = true;
+
+					Building* build = growBuilding(candidates[turn]);
+					if (!build)
+						continue;
+					grown[c].push_back(build);
+					processed++;
+				}
 			}
 
-			if (newBuilding)
+			if (processed > 0)
 			{
-				newBuilding->setAltitude((float)randBetween(1000, 5000));
-				addBuilding(newBuilding, false);
-				newBuildings++;
-				processed++;
+				// link everything that grew in one go, and give it its power
+				//   straight away instead of waiting for the next update
+				PowerManager* powerManager = m_sim->getPowerManager();
+				powerManager->addBuildings(grown);
+				powerManager->updatePower();
+
+				sortBuildings();
 			}
 		}
 
-		if (newBuildings > 0)
-			sortBuildings();
-
-		// remove invalid houses
+		// remove invalid houses, checking roughly a quarter of them each time
+		Random& cullRandom = m_sim->getRandom(RANDOMSTREAM_BUILDINGS);
 		for (int i = 0; i < m_buildings->getCount(); ++i)
 		{
 			Building* b = (*m_buildings)[i];
-			if (randBetween(0, 100) > 25)
+			if (cullRandom.randBetween(0, 100) > 25)
 				continue;
 			if (b->getType() != BUILDINGTYPE_HOUSE &&
 				b->getType() != BUILDINGTYPE_FACTORY &&
@@ -373,26 +378,26 @@ void BuildingManager::updateBuildings(float delta)
 			int ix, iy;
 			b->getPosition(&ix, &iy);
 
-			Tile* underHouse = m_game->getTileManager()->getTile(ix, iy);
+			ZoneType underHouse = tiles->getZoneType(ix, iy);
 
 			// check if the zone type matches the building
 			bool zoneMatches;
 			switch (b->getType())
 			{
 			case BUILDINGTYPE_HOUSE:
-				zoneMatches = underHouse->getZoneType() == ZONETYPE_RESIDENTIAL;
+				zoneMatches = underHouse == ZONETYPE_RESIDENTIAL;
 				break;
 			case BUILDINGTYPE_SHOP:
-				zoneMatches = underHouse->getZoneType() == ZONETYPE_COMMERCIAL;
+				zoneMatches = underHouse == ZONETYPE_COMMERCIAL;
 				break;
 			case BUILDINGTYPE_FACTORY:
-				zoneMatches = underHouse->getZoneType() == ZONETYPE_INDUSTRIAL;
+				zoneMatches = underHouse == ZONETYPE_INDUSTRIAL;
 				break;
 			default: 
 				zoneMatches = false;
 			}
 
-			if (underHouse->isLiveable() && zoneMatches)
+			if (tileManager->isTileLiveable(ix, iy) && zoneMatches)
 				continue;
 
 			// delete this invalid house
@@ -400,31 +405,121 @@ void BuildingManager::updateBuildings(float delta)
 		}
 
 		// make money from buildings
-		int factoryCount = getBuildingCount(BUILDINGTYPE_FACTORY);
-		int shopCount = getBuildingCount(BUILDINGTYPE_SHOP);
+		m_sim->addMoney(m_sim->getStats()->getIncome());
 
-		const float moneyPerFactory = 5.0f;
-		const float moneyPerShop = 1.0f;
+		m_houseTimer = HOUSE_UPDATE_TIME;// +(randBetween(-1.0f, 1.0f) * HOUSE_UPDATE_TIME * 0.5f);
+	}
+}
 
-		float newMoney = moneyPerFactory * factoryCount;
-		newMoney += moneyPerShop * shopCount;
-		m_game->addMoney((int)newMoney);
+void BuildingManager::findGrowthCandidates(const int chunk,
+	const unsigned int seed, GrowthChunk* out) const
+{
+	PROFILE_ZONE("BuildingManager growth chunk");
 
-		m_houseTimer = HOUSE_UPDATE_TIME;// +(randBetween(-1.0f, 1.0f) * HOUSE_UPDATE_TIME * 0.5f);
+	TileGrid* tiles = m_sim->getTiles();
+	TileManager* tileManager = m_sim->getTileManager();
+	const unsigned char* zones = tiles->getZoneData();
+
+	const int width = tiles->getWidth();
+	const int chunksWide = (width + GROWTH_CHUNK_SIZE - 1) / GROWTH_CHUNK_SIZE;
+
+	const int startX = (chunk % chunksWide) * GROWTH_CHUNK_SIZE;
+	const int startY = (chunk / chunksWide) * GROWTH_CHUNK_SIZE;
+	const int endX = std::min(startX + GROWTH_CHUNK_SIZE, width);
+	const int endY = std::min(startY + GROWTH_CHUNK_SIZE, tiles->getHeight());
+
+	for (int y = startY; y < endY; ++y)
+	{
+		for (int x = startX; x < endX; ++x)
+		{
+			int t = (y * width) + x;
+			if (zones[t] == ZONETYPE_NONE)
+				continue;
+			out->zonedCount++;
+
+			if (tiles->getBuilding(x, y))
+				continue;
+			if (!tileManager->isTileLiveable(x, y))
+				continue;
+
+			out->candidates.push_back(t);
+		}
+	}
+
+	// shuffle the tile list
+	// each chunk has its own stream of the tick's seed
+	Random random(seed, chunk);
+	for (int i = (int)out->candidates.size() - 1; i > 0; --i)
+	{
+		int swapWith = random.randBetween(0, i + 1);
+		std::swap(out->candidates[i], out->candidates[swapWith]);
 	}
 }
 
-void BuildingManager::drawBuildings(aie::Renderer2D* renderer) const
+Building* BuildingManager::growBuilding(const int tileIndex)
+{
+	TileGrid* tiles = m_sim->getTiles();
+
+	int xIndex = tileIndex % tiles->getWidth();
+	int yIndex = tileIndex / tiles->getWidth();
+
+	const float minDemand = 1.0f;
+
+	ZoneType zone = (ZoneType)tiles->getZoneData()[tileIndex];
+	BuildingType type;
+	switch (zone)
+	{
+	case ZONETYPE_RESIDENTIAL:
+		type = BUILDINGTYPE_HOUSE;
+		break;
+	case ZONETYPE_COMMERCIAL:
+		type = BUILDINGTYPE_SHOP;
+		break;
+	case ZONETYPE_INDUSTRIAL:
+		type = BUILDINGTYPE_FACTORY;
+		break;
+	case ZONETYPE_NONE:
+	case ZONETYPE_COUNT:
+	default:
+		return nullptr;
+	}
+
+	// only worked out again when a building's been added or removed
+	if (m_sim->getStats()->getDemand(zone) < minDemand)
+		return nullptr;
+
+	Building* newBuilding = makeBuilding(type, xIndex, yIndex);
+	if (!newBuilding)
+		return nullptr;
+
+	Random& random = m_sim->getRandom(RANDOMSTREAM_GROWTH);
+	newBuilding->setAltitude((float)random.randBetween(1000, 5000));
+
+	// sorted in one go once everything has grown
+	newBuilding->updateDepthKey();
+	m_buildings->add(newBuilding);
+	placeInWorld(newBuilding, false);
+	m_index->addBuilding(newBuilding);
+	return newBuilding;
+}
+
+void BuildingManager::drawBuildings(aie::Renderer2D* renderer,
+	const TileView& view) const
 {
 	for (int i = 0; i < m_buildings->getCount(); ++i)
 	{
 		Building* b = (*m_buildings)[i];
+		// skip anything off screen
+		int posX, posY;
+		b->getPosition(&posX, &posY);
+		if (!view.contains(posX, posY))
+			continue;
 		// if building view is off, we want to skip everything except roads
-		if (!m_game->isViewModeEnabled(VIEWMODE_BUILDINGS)
+		if (!m_sim->getGame()->isViewModeEnabled(VIEWMODE_BUILDINGS)
 			&& b->getType() != BUILDINGTYPE_ROAD)
 			continue;
 		// skip roads if road view is off
-		if (!m_game->isViewModeEnabled(VIEWMODE_ROADS)
+		if (!m_sim->getGame()->isViewModeEnabled(VIEWMODE_ROADS)
 			&& b->getType() == BUILDINGTYPE_ROAD)
 			continue;
 		renderer->setRenderColour(1, 1, 1);
@@ -442,39 +537,74 @@ void BuildingManager::addBuilding(Building* build, bool sort)
 		return;
 	}
 
-	m_buildings->add(build);
+	build->updateDepthKey();
 	if (sort)
-		sortBuildings();
-	if (build->getType() == BUILDINGTYPE_ROAD)
-		m_game->getRoadManager()->addRoad(build, sort);
+		insertSorted(build);
+	else
+		m_buildings->add(build);
+	placeInWorld(build, sort);
 
-	build->created();
+	m_index->addBuilding(build);
+
+	// hook it up to the power grid now the tiles know about it
+	m_sim->getPowerManager()->addBuilding(build);
+}
 
-	switch (build->getType())
+void BuildingManager::addBuildings(const std::vector<Building*>& builds)
+{
+	PROFILE_ZONE("BuildingManager::addBuildings");
+
+	m_buildings->reserve(m_buildings->getCount() + (int)builds.size());
+
+	std::vector<Building*> added;
+	added.reserve(builds.size());
+	for (auto build : builds)
 	{
-	case BUILDINGTYPE_HOUSE:
-		m_houseCount++;
-		break;
-	case BUILDINGTYPE_SHOP:
-		m_shopCount++;
-		break;
-	case BUILDINGTYPE_FACTORY:
-		m_factoryCount++;
-		break;
+		int posX, posY;
+		build->getPosition(&posX, &posY);
+		if (posX <= -1 || posY <= -1)
+		{
+			delete build;
+			continue;
+		}
+
+		build->updateDepthKey();
+		m_buildings->add(build);
+		placeInWorld(build, false);
+		added.push_back(build);
 	}
 
+	m_index->addBuildings(added);
+
+	// linking them one at a time would mean a search and an update for
+	//   each one, so the grid is built in one go now they're all there
+	m_sim->getPowerManager()->rebuild();
+
+	sortBuildings();
+}
+
+void BuildingManager::placeInWorld(Building* build, const bool sort)
+{
+	if (build->getType() == BUILDINGTYPE_ROAD)
+		m_sim->getRoadManager()->addRoad(build, sort);
+
+	build->created();
+
+	m_sim->getStats()->addBuilding(build->getType());
+
 	// let the tiles under the building know which building is on them
-	int sizeX, sizeY;
+	TileGrid* tiles = m_sim->getTiles();
+	int posX, posY, sizeX, sizeY;
+	build->getPosition(&posX, &posY);
 	build->getSize(&sizeX, &sizeY);
 	for (int y = posY; y > posY - sizeY; --y)
 	{
 		for (int x = posX; x > posX - sizeX; --x)
 		{
-			Tile* t = m_game->getTileManager()->getTile(x, y);
-			if (!t)
+			if (!tiles->isInBounds(x, y))
 				continue;
 
-			t->setBuilding(build);
+			tiles->setBuilding(x, y, build);
 		}
 	}
 }
@@ -483,11 +613,12 @@ void BuildingManager::addBuilding(Building* build, bool sort)
 void BuildingManager::placeBuilding(Building* build, bool sort)
 {
 	int buildingPrice = build->getPrice();
-	if (m_game->getMoney() < buildingPrice)
+	if (m_sim->getMoney() < buildingPrice)
 	{
 		// oh no you're too poor
 		// so we'll turn the money red so you know how poor you are
-		m_game->getUiManager()->flashMoney();
+		if (!m_sim->isHeadless())
+			m_sim->getGame()->getUiManager()->flashMoney();
 
 		// and then get rid of your building
 		delete build;
@@ -496,13 +627,13 @@ void BuildingManager::placeBuilding(Building* build, bool sort)
 	}
 
 	addBuilding(build, sort);
-	//m_game->addMoney(-build->getPrice());
+	//m_sim->addMoney(-build->getPrice());
 
 	char ptext[16];
-	sprintf_s(ptext, 16, "-$%d", build->getPrice());
+	snprintf(ptext, 16, "-$%d", build->getPrice());
 
 	Vector2 spawnPos = build->getWorldPosition();
-	m_game->spawnTextParticle(spawnPos, ptext);
+	m_sim->spawnTextParticle(spawnPos, ptext);
 }
 
 void BuildingManager::removeBuilding(Building* toRemove)
@@ -521,159 +652,93 @@ void BuildingManager::removeBuilding(Building* toRemove)
 		{
 			// grab the world position
 			Vector2 tPos =
-				m_game->getTileManager()->getTileWorldPosition(x, y);
+				m_sim->getTileManager()->getTileWorldPosition(x, y);
 			tPos.setX(tPos.getX() + TILE_WIDTH / 2.0f);
-			m_game->spawnSmokeParticle(tPos);
+			m_sim->spawnSmokeParticle(tPos);
 		}
 	}
 
 	// roads need to be deleted from the road manager
 	if (toRemove->getType() == BUILDINGTYPE_ROAD)
-		m_game->getRoadManager()->removeRoad(toRemove);
+		m_sim->getRoadManager()->removeRoad(toRemove);
+
+	// and everything needs to be unplugged from the power grid
+	m_sim->getPowerManager()->removeBuilding(toRemove);
 
 	toRemove->destroyed();
 
 	// let the tiles under the building know the building is gone
+	TileGrid* tiles = m_sim->getTiles();
 	for (int y = iy; y > iy - ih; --y)
 	{
 		for (int x = ix; x > ix - iw; --x)
 		{
-			Tile* t = m_game->getTileManager()->getTile(x, y);
-			if (!t)
+			if (!tiles->isInBounds(x, y))
 				continue;
 
-			t->setBuilding(nullptr);
+			tiles->setBuilding(x, y, nullptr);
 		}
 	}
 
+	m_index->removeBuilding(toRemove);
+	m_sim->getStats()->removeBuilding(toRemove->getType());
+	m_buildings->remove(toRemove);
+
 	// and actually delete it :)
 	delete toRemove;
-
-	// keep track of houses, shops and factories before we delete!
-	switch (toRemove->getType())
-	{
-	case BUILDINGTYPE_HOUSE:
-		m_houseCount--;
-		break;
-	case BUILDINGTYPE_SHOP:
-		m_shopCount--;
-		break;
-	case BUILDINGTYPE_FACTORY:
-		m_factoryCount--;
-		break;
-	}
-
-	m_buildings->remove(toRemove);
 }
 
 void BuildingManager::sortBuildings() const
 {
-	TileManager* tm = m_game->getTileManager();
+	struct KeyedBuilding
+	{
+		unsigned int	key;
+		Building*		build;
+	};
 
+	int count = m_buildings->getCount();
 	Building** ar = m_buildings->_getArray();
 
-	std::sort(ar, ar + m_buildings->getCount(), [tm](Building* a, Building* b)
-	{
-		int aCenterX, aCenterY;
-		a->getCenter(&aCenterX, &aCenterY);
-		Vector2 aPos = tm->getTileWorldPosition(aCenterX, aCenterY);
+	// copy the keys next to the pointers so sorting doesn't keep jumping
+	//   into every building
+	std::vector<KeyedBuilding> from(count), to(count);
+	for (int i = 0; i < count; ++i)
+		from[i] = { ar[i]->getDepthKey(), ar[i] };
 
-		int bCenterX, bCenterY;
-		b->getCenter(&bCenterX, &bCenterY);
-		Vector2 bPos = tm->getTileWorldPosition(bCenterX, bCenterY);
+	// least significant byte first, each pass keeps the order of the last
+	for (int shift = 0; shift < 32; shift += 8)
+	{
+		int offsets[257] = { 0 };
+		for (int i = 0; i < count; ++i)
+			offsets[((from[i].key >> shift) & 0xFF) + 1]++;
 
-		return aPos.getY() > bPos.getY();
-	});
-}
+		// every key has the same byte here, so this pass wouldn't move anything
+		if (count == 0 || offsets[((from[0].key >> shift) & 0xFF) + 1] == count)
+			continue;
 
-float BuildingManager::getDemand(const ZoneType zone) const
-{
-	float result;
+		for (int i = 1; i < 257; ++i)
+			offsets[i] += offsets[i - 1];
+		for (int i = 0; i < count; ++i)
+			to[offsets[(from[i].key >> shift) & 0xFF]++] = from[i];
 
-	switch (zone)
-	{
-	case ZONETYPE_RESIDENTIAL:
-		result = getResidentialDemand();
-		break;
-	case ZONETYPE_COMMERCIAL:
-		result = getCommercialDemand();
-		break;
-	case ZONETYPE_INDUSTRIAL:
-		result = getIndustrialDemand();
-		break;
-	default:
-		return -1.0f;
+		from.swap(to);
 	}
 
-	// raise the result to a silly power
-	// to make the differences more apparent but still comparatively the same
-	result = pow(result, 100);
-
-	// limit this result
-	const int maxDemand = 5;
-	if (result > maxDemand)
-		result = maxDemand;
-	if (result < -maxDemand)
-		result = -maxDemand;
-
-	return result;
+	for (int i = 0; i < count; ++i)
+		ar[i] = from[i].build;
 }
 
-const float factorySpace = 2.0f;
-const float shopSpace = 3.0f;
-
-float BuildingManager::getResidentialDemand() const
-{
-	/*
-	residents will not want to move in if:
-	- there aren't enough shops
-	- there aren't enough factories(jobs)
-	*/
-	// there will always be demand if no houses exist
-	// this is to ensure there's at least enough to get started
-	if (m_houseCount <= 0)
-		return 10.0f;
-
-	float shopsPerResident = (m_shopCount / (float)m_houseCount) * shopSpace;
-	float jobsPerResident = m_factoryCount / (m_houseCount / factorySpace);
-
-	return (shopsPerResident + jobsPerResident) / 2.0f;
-}
-float BuildingManager::getCommercialDemand() const
-{
-	/*
-	shops will not want to build if:
-	- there aren't enough residents
-	*/
-	if (m_shopCount <= 0)
-		return 10.0f;
-
-	float residentsPerShop = m_houseCount / (m_shopCount * shopSpace);
-	return residentsPerShop;
-}
-float BuildingManager::getIndustrialDemand() const
+void BuildingManager::insertSorted(Building* build)
 {
-	/*
-	factories will not want to build if:
-	- there aren't enough workers
-	*/
-	if (m_factoryCount <= 0)
-		return 10.0f;
-
-	float residentsPerJob = (m_houseCount / factorySpace) / (float)m_factoryCount;
-	return residentsPerJob;
-}
+	Building** ar = m_buildings->_getArray();
+	unsigned int key = build->getDepthKey();
 
-int BuildingManager::getBuildingCount(const BuildingType type) const
-{
-	int result = 0;
-	for (int i = 0; i < m_buildings->getCount(); ++i)
-	{
-		Building* b = (*m_buildings)[i];
-		if (b->getType() == type)
-			result++;
-	}
-	return result;
+	// find the first building that's in front of this one
+	int index = (int)(std::upper_bound(ar, ar + m_buildings->getCount(), key,
+		[](unsigned int k, const Building* b) { return k < b->getDepthKey(); })
+		- ar);
+
+	m_buildings->insert(index, build);
 }
 
 // returns whether or not the currently selected building can be placed at 
@@ -685,10 +750,11 @@ bool BuildingManager::canPlaceBuilding() const
 
 	// check its price
 	int thisPrice = m_ghostBuilding->getPrice();
-	int currentMoney = m_game->getMoney();
+	int currentMoney = m_sim->getMoney();
 	if (currentMoney < thisPrice)
 	{
-		m_game->getUiManager()->flashMoney();
+		if (!m_sim->isHeadless())
+			m_sim->getGame()->getUiManager()->flashMoney();
 		return false;
 	}
 
@@ -702,14 +768,13 @@ bool BuildingManager::canPlaceBuilding() const
 	buildingWidth--; buildingHeight--;
 
 	// check if the root position is outside of the world bounds
-	if (buildingX < 0 || buildingX >= WORLD_WIDTH ||
-		buildingY < 0 || buildingY >= WORLD_HEIGHT)
+	TileGrid* tiles = m_sim->getTiles();
+	if (!tiles->isInBounds(buildingX, buildingY))
 		return false;
 	// and also if the size is too big to fit on the map
 	int buildingLeft = buildingX - buildingWidth;
 	int buildingTop = buildingY - buildingHeight;
-	if (buildingLeft < 0 || buildingLeft >= WORLD_WIDTH ||
-		buildingTop < 0 || buildingTop >= WORLD_HEIGHT)
+	if (!tiles->isInBounds(buildingLeft, buildingTop))
 		return false;
 
 	// check if there are buildings in  the way
@@ -726,18 +791,17 @@ bool BuildingManager::canPlaceBuilding() const
 
 Building* BuildingManager::getBuildingAtIndex(int ix, int iy) const
 {
-	if (ix < 0 || iy < 0 || ix >= WORLD_WIDTH || iy >= WORLD_HEIGHT)
-		return nullptr;
-
-	Tile* t = m_game->getTileManager()->getTile(ix, iy);
-	if (!t)
+	TileGrid* tiles = m_sim->getTiles();
+	if (!tiles->isInBounds(ix, iy))
 		return nullptr;
 
-	return t->getBuilding();
+	return tiles->getBuilding(ix, iy);
 }
 
 void BuildingManager::clearBuildings()
 {
+	m_sim->getPowerManager()->clearBuildings();
+
 	for (int i = 0; i < m_buildings->getCount(); ++i)
 	{
 		Building* b = (*m_buildings)[i];
@@ -748,6 +812,11 @@ void BuildingManager::clearBuildings()
 		}
 	}
 	m_buildings->clear();
+
+	// and make sure nothing is left pointing at them
+	m_sim->getTiles()->clearBuildings();
+	m_index->clear();
+	m_sim->getStats()->clearBuildings();
 }
 
 // creates a building with type type
@@ -765,22 +834,22 @@ Building* BuildingManager::makeBuilding(const BuildingType type,
 	case BUILDINGTYPE_NONE:
 		return nullptr;
 	case BUILDINGTYPE_POWERPLANT:
-		b = new PowerPlant(m_game, xTile, yTile);
+		b = new PowerPlant(m_sim, xTile, yTile);
 		break;
 	case BUILDINGTYPE_POWERPOLE:
-		b = new PowerPole(m_game, xTile, yTile);
+		b = new PowerPole(m_sim, xTile, yTile);
 		break;
 	case BUILDINGTYPE_ROAD:
-		b = new Road(m_game, xTile, yTile);
+		b = new Road(m_sim, xTile, yTile);
 		break;
 	case BUILDINGTYPE_HOUSE:
-		b = new House(m_game, xTile, yTile);
+		b = new House(m_sim, xTile, yTile);
 		break;
 	case BUILDINGTYPE_SHOP:
-		b = new Shop(m_game, xTile, yTile);
+		b = new Shop(m_sim, xTile, yTile);
 		break;
 	case BUILDINGTYPE_FACTORY:
-		b = new Factory(m_game, xTile, yTile);
+		b = new Factory(m_sim, xTile, yTile);
 		break;
 	default:
 		printf("Tried to create a building that doesn't exist! Type: %d\n",
@@ -1,21 +1,26 @@
 #pragma once
 
+#include <vector>
+
 #include "Renderer2D.h"
 
-// time in seconds between updating the power state
-#define POWER_UPDATE_TIME 1
+#include "building.h"
+#include "tilegrid.h"
+
 // time in seconds between updating buildings
 #define HOUSE_UPDATE_TIME 2
+// tiles along each side of the square chunks zone growth is worked out in
+#define GROWTH_CHUNK_SIZE 32
 
 // Forward declares
 template <class T>
 class DArray;
 
 class Building;
-class Game;
-
-enum BuildingType;
-enum ZoneType;
+class Simulation;
+class BuildingIndex;
+struct TileView;
+struct GrowthChunk;
 
 // typedef the DArray so it's shorter to type
 typedef DArray<Building*> BuildingList;
@@ -25,11 +30,10 @@ class BuildingManager
 public:
 	//------------------------------------------------------------------------
 	// Param:
-	//			game:		pointer to our Game so we can access everything we 
-	//                      need
+	//			sim:		pointer to our Simulation so we can access everything
 	//			buildings:	pointer to the dynamic array of buildings
 	//------------------------------------------------------------------------
-	BuildingManager(Game* game, BuildingList* buildings);
+	BuildingManager(Simulation* sim, BuildingList* buildings);
 	~BuildingManager();
 
 	//------------------------------------------------------------------------
@@ -69,6 +73,14 @@ public:
 	//------------------------------------------------------------------------
 	BuildingList* getBuildings() const { return m_buildings; }
 	//------------------------------------------------------------------------
+	// Gets the spatial index of all buildings
+	// Used for finding buildings in an area and counting them
+	//
+	// Return: 
+	//			pointer to the BuildingIndex
+	//------------------------------------------------------------------------
+	BuildingIndex* getBuildingIndex() const { return m_index; }
+	//------------------------------------------------------------------------
 	// Deletes all buildings and clears the dynamic array
 	//------------------------------------------------------------------------
 	void clearBuildings();
@@ -82,22 +94,36 @@ public:
 	//------------------------------------------------------------------------
 	void updateBuildings(float delta);
 	//------------------------------------------------------------------------
-	// Draws all buildings
+	// Draws all buildings the camera can see
 	//
 	// Param: 
 	//			renderer: pointer to the renderer used to draw everything
+	//			view:     the tiles in view, buildings rooted outside it
+	//					  are skipped
 	//------------------------------------------------------------------------
-	void drawBuildings(aie::Renderer2D* renderer) const;
+	void drawBuildings(aie::Renderer2D* renderer, const TileView& view) const;
 	//------------------------------------------------------------------------
 	// Adds a building to the dynamic array
 	// Should be the ONLY way buildings are added to the world
 	//
 	// Param: 
 	//			build: the building to add to the array
-	//			sort:  whether or not to sort the array after adding
+	//			sort:  whether or not to insert it in draw order straight
+	//				   away, if not sortBuildings should be called after
+	//				   adding a batch
 	//------------------------------------------------------------------------
 	void addBuilding(Building* build, bool sort = true);
 	//------------------------------------------------------------------------
+	// Adds a whole batch of buildings at once, like when loading
+	// Everything is put in place first, then the power grid is built and
+	//   the buildings sorted just the once at the end
+	// Roads still need updateRoads to be called after
+	//
+	// Param: 
+	//			builds: the buildings to add, any off the map are deleted
+	//------------------------------------------------------------------------
+	void addBuildings(const std::vector<Building*>& builds);
+	//------------------------------------------------------------------------
 	// Used for when the player places a building
 	// Differs from addBuilding because it checks for and deals with money
 	//
@@ -117,30 +143,11 @@ public:
 	//------------------------------------------------------------------------
 	// Sorts the array of buildings based on their depth from the camera
 	// so they are drawn as expected in an isometric view
+	// This is a radix sort on the buildings' depth keys, meant for after
+	//   adding lots of buildings at once
 	//------------------------------------------------------------------------
 	void sortBuildings() const;
 
-	//------------------------------------------------------------------------
-	// Gets the demand for the specified zone to be created
-	//
-	// Param: 
-	//			zone: ZoneType enum of the zone to check the demand
-	// Return: 
-	//			a number representing demand of the zone
-	//			anything under 1 means there is no demand for it
-	//------------------------------------------------------------------------
-	float getDemand(ZoneType zone) const;
-	//------------------------------------------------------------------------
-	// Gets how many buildings of a specific type exist in the world
-	// Used in determining the demand for each zone
-	//
-	// Param: 
-	//			type: BuildingType enum of which building to count
-	// Return: 
-	//			how many buildings of the type exist
-	//------------------------------------------------------------------------
-	int getBuildingCount(BuildingType type) const;
-
 	//------------------------------------------------------------------------
 	// Gets the BuildingType the player has selected to build as an integer
 	//
@@ -170,8 +177,24 @@ public:
 	Building* makeBuilding(BuildingType type, int xTile, int yTile,
 		bool ghost = false) const;
 private:
-	Game*			m_game;
+	// puts a building into the already sorted array, in draw order
+	void insertSorted(Building* build);
+	// lets everything but the power grid and index know a building is
+	//   there, after it's been put in the array
+	void placeInWorld(Building* build, bool sort);
+	// finds the empty liveable zoned tiles in one chunk of the map and
+	//   shuffles them, only reads the world so it's safe to run on any thread
+	void findGrowthCandidates(int chunk, unsigned int seed,
+		GrowthChunk* out) const;
+	// grows the building the zone on a tile wants, if there's demand for it
+	// it's left for the caller to link into the power grid
+	// returns the building that was made, or nullptr if none was
+	Building* growBuilding(int tileIndex);
+
+	Simulation*			m_sim;
 	BuildingList*	m_buildings;
+	// the same buildings, sorted into chunks by position
+	BuildingIndex*	m_index;
 
 	// type of building the player has selected to build
 	int				m_selectedBuilding;
@@ -184,14 +207,6 @@ private:
 	int				m_dragPosX, m_dragPosY;
 	bool			m_isDragHorizontal;
 
-	// timers used to update power and zone population
-	float			m_powerTimer;
+	// timer used to update zone population
 	float			m_houseTimer;
-
-	// variables to keep track of the number of buildings used in demand calcs
-	int m_houseCount, m_shopCount, m_factoryCount;
-	// functions called by getDemand for individual zone demands
-	float getResidentialDemand() const;
-	float getCommercialDemand() const;
-	float getIndustrialDemand() const;
 };
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "game.h"
 #include "camera.h"
 #include "random.h"
+#include "tilegrid.h"
+#include "simulation.h"
 
 Camera::Camera(Game* game) : m_game(game)
 {
@@ -74,8 +76,11 @@ void Camera::update(float delta)
 	m_targetScale -= (float)dif * 0.1f;
 	m_lastScroll = scrollAmt;
 
-	if (m_targetScale < 0.2f)
-		m_targetScale = 0.2f;
+	if (m_targetScale < CAMERA_MIN_SCALE)
+		m_targetScale = CAMERA_MIN_SCALE;
+	float maxScale = getMaxScale();
+	if (m_targetScale > maxScale)
+		m_targetScale = maxScale;
 
 	// smoothly moves towards target position
 	m_actualX -= (m_actualX - m_targetX) * m_smoothSpeed * delta;
@@ -86,10 +91,11 @@ void Camera::update(float delta)
 	if (m_shakeAmount > 0)
 	{
 		const float rndamt = 10.0f;
+		Random& random = m_game->getRandom(RANDOMSTREAM_CAMERA);
 		m_actualX += rndamt * m_shakeAmount
-			* (randBetween(0, 100) < 50 ? -1 : 1);
+			* (random.randBetween(0, 100) < 50 ? -1 : 1);
 		m_actualY += rndamt * m_shakeAmount
-			* (randBetween(0, 100) < 50 ? -1 : 1);
+			* (random.randBetween(0, 100) < 50 ? -1 : 1);
 
 		const float decreaseSpeed = 20.0f;
 		m_shakeAmount -= m_shakeAmount * delta * decreaseSpeed;
@@ -118,6 +124,23 @@ void Camera::screenToWorld(float* x, float* y)
 	*y = bottom + (yPercentage * scaledHeight);
 }
 
+// works out where the corners of the screen are in the world
+void Camera::getViewBounds(float* left, float* bottom, float* right,
+	float* top)
+{
+	float x1 = 0.0f;
+	float y1 = 0.0f;
+	float x2 = (float)m_game->getWindowWidth();
+	float y2 = (float)m_game->getWindowHeight();
+	screenToWorld(&x1, &y1);
+	screenToWorld(&x2, &y2);
+
+	*left = x1 < x2 ? x1 : x2;
+	*right = x1 < x2 ? x2 : x1;
+	*bottom = y1 < y2 ? y1 : y2;
+	*top = y1 < y2 ? y2 : y1;
+}
+
 // getters and setters
 
 void Camera::setPosition(float x, float y)
@@ -144,6 +167,33 @@ void Camera::setCurrentScale(float s) { m_actualScale = s; }
 float Camera::getScale() { return m_actualScale; }
 float Camera::getTargetScale() { return m_targetScale; }
 
+float Camera::getMaxScale()
+{
+	// the world is a diamond as wide and as tall as its width + height in
+	//   half tiles
+	TileGrid* tiles = m_game->getSimulation()->getTiles();
+	float halfTiles = (float)(tiles->getWidth() + tiles->getHeight());
+	float worldWidth = halfTiles * TILE_WIDTH / 2.0f;
+	float worldHeight = halfTiles * TILE_HEIGHT / 3.0f;
+
+	float scaleX = worldWidth / (float)m_game->getWindowWidth();
+	float scaleY = worldHeight / (float)m_game->getWindowHeight();
+	float maxScale = (scaleX > scaleY ? scaleX : scaleY)
+		* CAMERA_OVERVIEW_MARGIN;
+
+	// small worlds can still be zoomed out a little
+	return maxScale > 1.0f ? maxScale : 1.0f;
+}
+
+LodLevel Camera::getLodLevel()
+{
+	if (m_actualScale >= LOD_OVERVIEW_SCALE)
+		return LODLEVEL_OVERVIEW;
+	if (m_actualScale >= LOD_FLAT_SCALE)
+		return LODLEVEL_FLAT;
+	return LODLEVEL_FULL;
+}
+
 void	Camera::setSpeed(float spd) { m_smoothSpeed = spd; }
 float	Camera::getSpeed() { return m_smoothSpeed; }
 
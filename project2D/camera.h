@@ -1,5 +1,24 @@
 #pragma once
 
+// how far in the camera can zoom
+#define CAMERA_MIN_SCALE 0.2f
+// how much room is left around the whole world when zoomed all the way out
+#define CAMERA_OVERVIEW_MARGIN 1.25f
+
+// scales past which the world is drawn with less detail, see LodLevel
+#define LOD_FLAT_SCALE 4.0f
+#define LOD_OVERVIEW_SCALE 16.0f
+
+// how much detail the world is drawn with, picked from the camera's scale
+enum LodLevel
+{
+	LODLEVEL_FULL = 0,	// every tile and building sprite
+	LODLEVEL_FLAT,		// a flat colour per tile, with buildings as markers
+	LODLEVEL_OVERVIEW,	// the same, but one colour for a few tiles at once
+
+	LODLEVEL_COUNT // the total number of levels
+};
+
 class Game;
 
 class Camera
@@ -10,6 +29,8 @@ public:
 	void update(float delta);
 
 	void screenToWorld(float* x, float* y);
+	// gets the edges of the part of the world that's on screen
+	void getViewBounds(float* left, float* bottom, float* right, float* top);
 
 	// these set the target positions - the positions the camera will smoothly 
 	// move to
@@ -28,6 +49,23 @@ public:
 	float getTargetScale();
 	void  getPosition(float* x, float* y);
 
+	//------------------------------------------------------------------------
+	// Gets the furthest the camera can zoom out, which is just enough to fit
+	//   the whole world on screen
+	//
+	// Return:
+	//			the largest scale the camera can have
+	//------------------------------------------------------------------------
+	float getMaxScale();
+	//------------------------------------------------------------------------
+	// Gets how much detail the world should be drawn with at the current
+	//   scale
+	//
+	// Return:
+	//			the level of detail to draw with
+	//------------------------------------------------------------------------
+	LodLevel getLodLevel();
+
 	void  setSpeed(float spd);
 	float getSpeed();
 
@@ -0,0 +1,134 @@
+#include "citystats.h"
+
+#include <cmath>
+
+// how many residents each building has room for
+const float factorySpace = 2.0f;
+const float shopSpace = 3.0f;
+
+CityStats::CityStats()
+	: m_poweredArea(0)
+{
+	clearBuildings();
+	countZones(nullptr, 0);
+}
+
+void CityStats::addBuilding(const BuildingType type)
+{
+	m_buildingCounts[type]++;
+	m_demandDirty = true;
+}
+
+void CityStats::removeBuilding(const BuildingType type)
+{
+	m_buildingCounts[type]--;
+	m_demandDirty = true;
+}
+
+void CityStats::clearBuildings()
+{
+	for (int i = 0; i < BUILDINGTYPE_COUNT; ++i)
+		m_buildingCounts[i] = 0;
+	m_demandDirty = true;
+}
+
+void CityStats::changeZone(const ZoneType from, const ZoneType to)
+{
+	m_zonedArea[from]--;
+	m_zonedArea[to]++;
+}
+
+void CityStats::countZones(const unsigned char* zones, const int count)
+{
+	for (int i = 0; i < ZONETYPE_COUNT; ++i)
+		m_zonedArea[i] = 0;
+	for (int i = 0; i < count; ++i)
+		m_zonedArea[zones[i]]++;
+}
+
+int CityStats::getIncome() const
+{
+	return INCOME_PER_FACTORY * m_buildingCounts[BUILDINGTYPE_FACTORY]
+		+ INCOME_PER_SHOP * m_buildingCounts[BUILDINGTYPE_SHOP];
+}
+
+float CityStats::getDemand(const ZoneType zone) const
+{
+	if (m_demandDirty)
+		updateDemand();
+	return m_demand[zone];
+}
+
+float CityStats::getDisplayDemand(const ZoneType zone) const
+{
+	if (m_demandDirty)
+		updateDemand();
+	return m_displayDemand[zone];
+}
+
+void CityStats::updateDemand() const
+{
+	int houseCount = m_buildingCounts[BUILDINGTYPE_HOUSE];
+	int shopCount = m_buildingCounts[BUILDINGTYPE_SHOP];
+	int factoryCount = m_buildingCounts[BUILDINGTYPE_FACTORY];
+
+	/*
+	residents will not want to move in if:
+	- there aren't enough shops
+	- there aren't enough factories(jobs)
+	*/
+	// there will always be demand if no houses exist
+	// this is to ensure there's at least enough to get started
+	float& resDemand = m_demand[ZONETYPE_RESIDENTIAL];
+	if (houseCount <= 0)
+	{
+		resDemand = 10.0f;
+	}
+	else
+	{
+		float shopsPerResident = (shopCount / (float)houseCount) * shopSpace;
+		float jobsPerResident = factoryCount / (houseCount / factorySpace);
+		resDemand = (shopsPerResident + jobsPerResident) / 2.0f;
+	}
+
+	/*
+	shops will not want to build if:
+	- there aren't enough residents
+	*/
+	float& comDemand = m_demand[ZONETYPE_COMMERCIAL];
+	if (shopCount <= 0)
+		comDemand = 10.0f;
+	else
+		comDemand = houseCount / (shopCount * shopSpace);
+
+	/*
+	factories will not want to build if:
+	- there aren't enough workers
+	*/
+	float& indDemand = m_demand[ZONETYPE_INDUSTRIAL];
+	if (factoryCount <= 0)
+		indDemand = 10.0f;
+	else
+		indDemand = (houseCount / factorySpace) / (float)factoryCount;
+
+	m_demand[ZONETYPE_NONE] = -1.0f;
+	m_displayDemand[ZONETYPE_NONE] = -1.0f;
+
+	for (int zone = ZONETYPE_RESIDENTIAL; zone < ZONETYPE_COUNT; ++zone)
+	{
+		// raise the result to a silly power
+		// to make the differences more apparent but still comparatively the same
+		float result = pow(m_demand[zone], 100);
+
+		// limit this result
+		const int maxDemand = 5;
+		if (result > maxDemand)
+			result = maxDemand;
+		if (result < -maxDemand)
+			result = -maxDemand;
+
+		m_displayDemand[zone] = result;
+	}
+
+	m_demandDirty = false;
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+
+#include "building.h" // for BUILDINGTYPE_COUNT enum
+#include "tilegrid.h" // for ZONETYPE_COUNT enum
+
+// money made each time buildings grow, for each building of the type
+#define INCOME_PER_FACTORY 5
+#define INCOME_PER_SHOP 1
+
+// totals for the whole city, kept up to date as things change rather than
+//   counted up whenever they're needed
+// the BuildingManager tells it about buildings and the TileGrid about zones
+//   and power, so every getter is just a lookup
+class CityStats
+{
+public:
+	CityStats();
+
+	// we don't expect CityStats to be copied/moved
+	CityStats(const CityStats& cs) = delete;
+	CityStats(CityStats&& cs) = delete;
+	CityStats& operator=(CityStats& cs) = delete;
+	CityStats& operator=(CityStats&& cs) = delete;
+
+	//------------------------------------------------------------------------
+	// Counts a building being added to or removed from the world
+	//
+	// Param:
+	//			type: BuildingType of the building
+	//------------------------------------------------------------------------
+	void addBuilding(BuildingType type);
+	void removeBuilding(BuildingType type);
+	//------------------------------------------------------------------------
+	// Forgets every building, for when they're all cleared at once
+	//------------------------------------------------------------------------
+	void clearBuildings();
+
+	//------------------------------------------------------------------------
+	// Counts a tile's zone changing
+	//
+	// Param:
+	//			from: the zone the tile had
+	//			to:   the zone the tile has now
+	//------------------------------------------------------------------------
+	void changeZone(ZoneType from, ZoneType to);
+	//------------------------------------------------------------------------
+	// Counts every tile's zone from scratch, for when the zones are all
+	//   replaced at once
+	//
+	// Param:
+	//			zones: the zone of each tile
+	//			count: how many tiles there are
+	//------------------------------------------------------------------------
+	void countZones(const unsigned char* zones, int count);
+	//------------------------------------------------------------------------
+	// Counts tiles gaining or losing power
+	// Safe to call from several jobs at once
+	//
+	// Param:
+	//			amount: how many more tiles have power, negative if they lost it
+	//------------------------------------------------------------------------
+	void changePoweredArea(int amount) { m_poweredArea += amount; }
+	//------------------------------------------------------------------------
+	// Forgets every powered tile, for when power is cleared at once
+	//------------------------------------------------------------------------
+	void clearPoweredArea() { m_poweredArea = 0; }
+
+	//------------------------------------------------------------------------
+	// Gets how many buildings of a specific type exist in the world
+	//
+	// Param:
+	//			type: BuildingType enum of which building to count
+	// Return:
+	//			how many buildings of the type exist
+	//------------------------------------------------------------------------
+	int getBuildingCount(BuildingType type) const { return m_buildingCounts[type]; }
+	//------------------------------------------------------------------------
+	// Gets how many tiles have a zone
+	//
+	// Param:
+	//			zone: ZoneType to count the tiles of
+	// Return:
+	//			how many tiles are zoned as that type
+	//------------------------------------------------------------------------
+	int getZonedArea(ZoneType zone) const { return m_zonedArea[zone]; }
+	//------------------------------------------------------------------------
+	// Gets how many tiles have power
+	//------------------------------------------------------------------------
+	int getPoweredArea() const { return m_poweredArea; }
+	//------------------------------------------------------------------------
+	// Gets how much money the buildings make each time buildings grow
+	//------------------------------------------------------------------------
+	int getIncome() const;
+
+	//------------------------------------------------------------------------
+	// Gets the demand for the specified zone to be built on
+	// Only worked out again after the buildings change
+	//
+	// Param:
+	//			zone: ZoneType enum of the zone to check the demand
+	// Return:
+	//			a number representing demand of the zone
+	//			anything under 1 means there is no demand for it
+	//------------------------------------------------------------------------
+	float getDemand(ZoneType zone) const;
+	//------------------------------------------------------------------------
+	// Gets the demand for a zone exaggerated for showing in the UI, where
+	//   small differences are hard to see
+	//
+	// Param:
+	//			zone: ZoneType enum of the zone to check the demand
+	// Return:
+	//			the demand for the zone between -5 and 5, -1 for no zone
+	//------------------------------------------------------------------------
+	float getDisplayDemand(ZoneType zone) const;
+private:
+	int					m_buildingCounts[BUILDINGTYPE_COUNT];
+	int					m_zonedArea[ZONETYPE_COUNT];
+	// changed from the power jobs, so it has to be atomic
+	std::atomic<int>	m_poweredArea;
+
+	// the demand only depends on the building counts, so it's worked out
+	//   the first time it's asked for after they change
+	mutable bool		m_demandDirty;
+	mutable float		m_demand[ZONETYPE_COUNT];
+	mutable float		m_displayDemand[ZONETYPE_COUNT];
+
+	// works out every zone's demand from the building counts
+	void updateDemand() const;
+};
\ No newline at end of file
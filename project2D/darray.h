@@ -54,6 +54,44 @@ public:
 			resize(m_size * 2);
 	}
 
+	//------------------------------------------------------------------------
+	// Makes room for a number of items, so adding that many doesn't have to
+	//   keep resizing the array
+	//
+	// Param: 
+	//			count: how many items the array should be able to hold
+	//------------------------------------------------------------------------
+	void reserve(int count)
+	{
+		// add resizes once it's one away from full, so leave room for that
+		if (count + 1 >= m_size)
+			resize(count + 2);
+	}
+
+	//------------------------------------------------------------------------
+	// Inserts an element into the array, moving everything after it along
+	//
+	// Param: 
+	//			index: where the item will end up, from 0 to getCount()
+	//			item:  item to insert
+	//------------------------------------------------------------------------
+	void insert(int index, const T& item)
+	{
+		// make sure we're in the bounds of the array
+		if (index < 0 || index > m_itemCount)
+			return;
+
+		// shift all elements right, making a gap at index
+		for (int i = m_itemCount; i > index; --i)
+			m_items[i] = m_items[i - 1];
+		m_items[index] = item;
+		m_itemCount++;
+
+		// resize if we get close to max size
+		if (m_itemCount >= m_size - 1)
+			resize(m_size * 2);
+	}
+
 	//------------------------------------------------------------------------
 	// Removes an item from the array
 	//
@@ -1,12 +1,12 @@
 #include "factory.h"
 
-#include "game.h"
-#include "tile.h"
 #include "random.h"
+#include "simulation.h"
 #include "imagemanager.h"
+#include "pollutionmanager.h"
 
-Factory::Factory(Game* game, int x, int y)
-	: Building(game, x, y)
+Factory::Factory(Simulation* sim, int x, int y)
+	: Building(sim, x, y)
 {
 	m_type = BUILDINGTYPE_FACTORY;
 	m_buildStyle = BUILDSTYLE_FORBIDDEN;
@@ -16,10 +16,9 @@ Factory::Factory(Game* game, int x, int y)
 	m_powerSpreadRange = 0;
 	m_shakesCamera = false;
 
-	m_tileAffectRange = 7;
-
-	m_texture = m_game->getImageManager()->getTexture("buildings/factory");
-	m_smokePuffTime = randBetween(3.0f, 30.0f);
+	m_sprite = m_sim->getImageManager()->getSprite(SPRITE_FACTORY);
+	m_smokePuffTime =
+		m_sim->getRandom(RANDOMSTREAM_BUILDINGS).randBetween(3.0f, 30.0f);
 }
 
 void Factory::update(float delta)
@@ -32,8 +31,9 @@ void Factory::update(float delta)
 		// make a smoke puff!
 		Vector2 pos = m_worldPos;
 		pos += Vector2(TILE_WIDTH / 2.0f - 32.0f, TILE_HEIGHT);
-		m_game->spawnPollutionParticle(pos);
-		m_smokePuffTime = randBetween(3.0f, 12.0f);
+		m_sim->spawnPollutionParticle(pos);
+		m_smokePuffTime =
+			m_sim->getRandom(RANDOMSTREAM_BUILDINGS).randBetween(3.0f, 12.0f);
 	}
 }
 
@@ -44,16 +44,20 @@ void Factory::draw(aie::Renderer2D* renderer)
 
 	const float xOrigin = 0.5f;
 	const float yOrigin = 0.0f;
-	renderer->drawSprite(m_texture, m_worldPos.getX(),
-		m_worldPos.getY() + m_altitude - 3, 0, 0, 0, 0, xOrigin, yOrigin);
+	m_sprite->draw(renderer, m_worldPos.getX(),
+		m_worldPos.getY() + m_altitude - 3, 0, 0, xOrigin, yOrigin);
 }
 
-void Factory::affectTile(Tile* t)
+void Factory::created()
 {
-	t->addPollution(FACTORY_POLLUTION_AMT);
+	Building::created();
+	m_sim->getPollutionManager()->addEmitter(m_posX, m_posY,
+		FACTORY_POLLUTION_AMT);
 }
 
-void Factory::unaffectTile(Tile* t)
+void Factory::destroyed()
 {
-	t->addPollution(-FACTORY_POLLUTION_AMT);
+	Building::destroyed();
+	m_sim->getPollutionManager()->removeEmitter(m_posX, m_posY,
+		FACTORY_POLLUTION_AMT);
 }
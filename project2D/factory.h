@@ -2,19 +2,21 @@
 
 #include "building.h"
 
-// how much pollution a factory gives to nearby tiles
+// how polluted a factory makes its own tile, less further away
 #define FACTORY_POLLUTION_AMT 10
 
 class Factory : public Building
 {
 public:
-	Factory(Game* game, int x, int y);
+	Factory(Simulation* sim, int x, int y);
 
 	void update(float delta) override;
 	void draw(aie::Renderer2D* renderer) override;
 
-	void affectTile(Tile* t) override;
-	void unaffectTile(Tile* t) override;
+	// factories give off pollution from when they're added until they're
+	//   removed
+	void created() override;
+	void destroyed() override;
 private:
 	// how long it has been since producing a puff to indicate pollution
 	float m_smokePuffTime;
@@ -9,67 +9,50 @@
 // bootstrap includes
 #include "Font.h"
 #include "Input.h"
+#include "Profiler.h"
 #include "Texture.h"
 
 // all other includes sorted by filename length
-#include "tile.h"
 #include "camera.h"
-#include "darray.h"
+#include "tilegrid.h"
 #include "building.h"
 #include "uimanager.h"
 #include "roadmanager.h"
 #include "savemanager.h"
 #include "tilemanager.h"
 #include "imagemanager.h"
-#include "textparticle.h"
-#include "smokeparticle.h"
+#include "particlesystem.h"
 #include "buildingmanager.h"
-#include "pollutionparticle.h"
 
 Game::Game() {}
 Game::~Game() {}
 
 bool Game::startup()
 {
-	srand((unsigned int)time(NULL));
 	this->setVSync(true);
 
 	// sky blue background
 	setBackgroundColour(0.12f, 0.63f, 1.0f);
 
-	m_buildings = new BuildingList;
-	m_particles = new ParticleList;
-
 	m_2dRenderer = new aie::Renderer2D();
 	m_camera = new Camera(this);
 
-	// I need a managers for all these managers
-	m_imageManager = new ImageManager();
+	// the simulation makes the world and the managers which look after it
+	m_simulation = new Simulation(this);
+	// a new seed each time the game's played, printed so a run can be
+	//   played again the same way
+	m_simulation->setSeed((unsigned int)time(NULL));
+	printf("Random seed: %u\n", m_simulation->getSeed());
 	m_uiManager = new UiManager(this);
-	m_buildingManager = new BuildingManager(this, m_buildings);
-	m_roadManager = new RoadManager(this);
-	m_saveManager = new SaveManager(this);
-	m_tileManager = new TileManager(this, &m_tiles);
 
 	m_uiFont = new aie::Font("./font/roboto.ttf", 16);
 	m_uiFontLarge = new aie::Font("./font/roboto.ttf", 24);
 
-	// power icon used for the power viewmode
-	m_powerIcon = m_imageManager->getTexture("icons/power");
-
-	m_mapStart = Vector2(1200, 800);
+	// particles get their sprites from the simulation's ImageManager
+	m_particles = new ParticleSystem(this);
 
-	m_tiles = new Tile**[WORLD_HEIGHT];
-	// initialize tiles to grass tiles
-	for (int y = 0; y < WORLD_HEIGHT; ++y)
-	{
-		m_tiles[y] = new Tile*[WORLD_WIDTH];
-		for (int x = 0; x < WORLD_WIDTH; ++x)
-		{
-			m_tiles[y][x] = new Tile(this,
-				m_imageManager->getTexture("tiles/grass_flat"));
-		}
-	}
+	// power icon used for the power viewmode
+	m_powerIcon = getImageManager()->getSprite(SPRITE_ICON_POWER);
 
 	m_placeMode = PLACEMODE_NONE;
 	// default view mode shows zones, buildings and roads
@@ -77,65 +60,38 @@ bool Game::startup()
 		VIEWMODE_BUILDINGS |
 		VIEWMODE_ROADS));
 
-	m_money = 2000;
-
 	return true;
 }
 
 void Game::shutdown()
 {
+	// keep whatever the profiler caught before everything goes away
+	PROFILE_DUMP(PROFILE_FILENAME);
+
 	delete m_uiFont;
 	delete m_uiFontLarge;
 	delete m_2dRenderer;
 	delete m_camera;
 
-	m_buildingManager->clearBuildings();
-	delete m_buildingManager;
-	delete m_roadManager;
-	delete m_saveManager;
-	delete m_tileManager;
-	delete m_imageManager;
 	delete m_uiManager;
+	delete m_simulation;
 
-	for (int i = 0; i < m_particles->getCount(); ++i)
-		delete (*m_particles)[i];
 	delete m_particles;
-	delete m_buildings;
-
-	for (int y = 0; y < WORLD_HEIGHT; ++y)
-	{
-		for (int x = 0; x < WORLD_WIDTH; ++x)
-		{
-			if (m_tiles[y][x] != nullptr)
-				delete m_tiles[y][x];
-		}
-		// delete this column
-		delete[] m_tiles[y];
-	}
-	// delete the array of columns
-	delete[] m_tiles;
 }
 
 void Game::update(float deltaTime)
 {
+	PROFILE_ZONE("Game::update");
+
 	// cap delta so it's doesn't super break if lag happens
 	if (deltaTime > 0.33f)
 		deltaTime = 0.33f;
 
-	// update particles
-	for (int i = 0; i < m_particles->getCount(); ++i)
-		(*m_particles)[i]->update(deltaTime);
+	// finish off any textures that have been loading in the background
+	getImageManager()->update();
 
-	// delete any particles that need it
-	for (int i = m_particles->getCount() - 1; i >= 0; --i)
-	{
-		Particle* p = (*m_particles)[i];
-		if (p->getOpacity() <= 0.0f)
-		{
-			delete p;
-			m_particles->remove(i);
-		}
-	}
+	// update particles, which also removes faded ones
+	m_particles->update(deltaTime);
 
 	aie::Input* input = aie::Input::getInstance();
 
@@ -183,7 +139,7 @@ void Game::update(float deltaTime)
 
 	m_camera->update(deltaTime);
 	getUiManager()->update(deltaTime);
-	getBuildingManager()->updateBuildings(deltaTime);
+	m_simulation->update(deltaTime);
 
 	// temporary save/load keys
 	if (input->wasKeyPressed(aie::INPUT_KEY_F))
@@ -204,17 +160,26 @@ void Game::update(float deltaTime)
 
 	// keys just to demonstrate these functions
 	if (input->wasKeyPressed(aie::INPUT_KEY_J))
-		m_saveManager->loadBuildings();
+		getSaveManager()->loadBuildings();
 	if (input->wasKeyPressed(aie::INPUT_KEY_K))
-		m_saveManager->saveBuildings();
+		getSaveManager()->saveBuildings();
 	if (input->wasKeyPressed(aie::INPUT_KEY_G))
-		m_saveManager->loadTiles();
+		getSaveManager()->loadTiles();
 	if (input->wasKeyPressed(aie::INPUT_KEY_H))
-		m_saveManager->saveTiles();
+		getSaveManager()->saveTiles();
+
+	// dump the profiler's recent history, handy right after a hitch
+	if (input->wasKeyPressed(aie::INPUT_KEY_F12))
+	{
+		PROFILE_DUMP(PROFILE_FILENAME);
+		printf("Wrote profile to %s\n", PROFILE_FILENAME);
+	}
 }
 
 void Game::draw()
 {
+	PROFILE_ZONE("Game::draw");
+
 	// wipe the screen to the background colour
 	clearScreen();
 
@@ -229,71 +194,65 @@ void Game::draw()
 
 	// draw tiles
 	Vector2 mousePos = getMouseWorldPosition();
-	Tile* mouseOver = m_tileManager->getTileAtPosition(mousePos);
+	TileManager* tileManager = getTileManager();
+	TileGrid* tiles = m_simulation->getTiles();
 	int mouseOverX, mouseOverY;
+	tileManager->getTileAtPosition(mousePos, &mouseOverX, &mouseOverY);
+	bool mouseOver = mouseOverX >= 0 && mouseOverY >= 0;
 	// don't show mouseover stuff if the mouse is over the UI
 	if (!isMouseInGame())
-		mouseOver = nullptr;
+		mouseOver = false;
 
 	// only show zone tint when it's relevant
 	bool tintTiles = getPlaceMode() == PLACEMODE_ZONE
 		|| isViewModeEnabled(VIEWMODE_ZONE);
 
-	// draw all our tiles
-	for (int y = 0; y < WORLD_HEIGHT; ++y)
-	{
-		for (int x = 0; x < WORLD_WIDTH; ++x)
-		{
-			Tile* thisTile = m_tiles[y][x];
-			if (thisTile == nullptr)
-				continue;
-			// make sure the tile knows where it is in the array
-			thisTile->setIndices(x, y);
-
-			float rg = 1.0f;
-			if (mouseOver == thisTile)
-			{
-				// set the tint colour
-				rg = 0.5f;
-				// and keep track of the mouseover location
-				mouseOverX = x;
-				mouseOverY = y;
-			}
-			// set the colour to a tint or full colour
-			m_2dRenderer->setRenderColour(rg, rg, 1.0f);
-
-			Vector2 tilePos = m_tileManager->getTileWorldPosition(x, y);
-			// I'm not sure why I subtracted 20 here but let's go with it
-			tilePos.setY(tilePos.getY() - 20.0f);
+	// only bother with the tiles the camera can see
+	float viewLeft, viewBottom, viewRight, viewTop;
+	m_camera->getViewBounds(&viewLeft, &viewBottom, &viewRight, &viewTop);
+	TileView view = tileManager->getTilesInView(viewLeft, viewBottom,
+		viewRight, viewTop);
 
-			// account for the difference in height in the texture
-			// and keep the bottoms aligned
-			float dify = TILE_HEIGHT -
-				(float)thisTile->getTexture()->getHeight();
+	// zoomed out, the buildings are drawn into the tiles as markers
+	LodLevel lod = m_camera->getLodLevel();
+	bool fullDetail = lod == LODLEVEL_FULL;
 
-			// don't let the tile class tint the sprite if this is
-			//   being moused over
-			bool tintThisTile = tintTiles && thisTile != mouseOver;
+	// the ground barely changes, so it's kept on the GPU in chunks
+	tileManager->drawTiles(m_2dRenderer, view, lod, tintTiles);
 
-			thisTile->draw(m_2dRenderer, tilePos.getX(),
-				tilePos.getY() - dify / 2.0f, tintThisTile);
+	// the mouseover tile gets a blue tint drawn over it
+	if (mouseOver)
+	{
+		m_2dRenderer->setRenderColour(0x7f7fffff);
+		tileManager->drawTile(m_2dRenderer, mouseOverX, mouseOverY);
+	}
 
-			// draw power icon if needed
-			if (isViewModeEnabled(VIEWMODE_POWER) && thisTile->hasPower())
+	// draw power icons if needed
+	// they'd be too small to see zoomed out anyway
+	if (fullDetail && isViewModeEnabled(VIEWMODE_POWER))
+	{
+		m_2dRenderer->setRenderColour(1, 1, 0);
+		for (int y = view.minY; y <= view.maxY; ++y)
+		{
+			int minX, maxX;
+			view.getRow(y, &minX, &maxX);
+			for (int x = minX; x <= maxX; ++x)
 			{
-				m_2dRenderer->setRenderColour(1, 1, 0);
-				m_2dRenderer->drawSprite(m_powerIcon,
-					tilePos.getX() + TILE_WIDTH / 2.0f, tilePos.getY() + 20.0f);
+				if (!tiles->hasPower(x, y))
+					continue;
+				Vector2 pos = tileManager->getTileWorldPosition(x, y);
+				m_powerIcon->draw(m_2dRenderer,
+					pos.getX() + TILE_WIDTH / 2.0f, pos.getY());
 			}
 		}
 	}
 
-	// draw buildings
-	getBuildingManager()->drawBuildings(m_2dRenderer);
-
-	// draw particles
-	for (int i = 0; i < m_particles->getCount(); ++i)
-		(*m_particles)[i]->draw(m_2dRenderer);
+	// draw buildings and particles
+	if (fullDetail)
+	{
+		getBuildingManager()->drawBuildings(m_2dRenderer, view);
+		m_particles->draw(m_2dRenderer);
+	}
 
 	// draw overlay stuff from place mode
 	switch (m_placeMode)
@@ -331,7 +290,7 @@ void Game::draw()
 	// draw mouseover stuff if we need
 	Building* b = nullptr;
 	if (mouseOver)
-		b = m_buildingManager->getBuildingAtIndex(mouseOverX, mouseOverY);
+		b = getBuildingManager()->getBuildingAtIndex(mouseOverX, mouseOverY);
 	if (b)
 	{
 		// draw mouseover stuff
@@ -344,7 +303,7 @@ void Game::draw()
 		aie::Font* titleFont = m_uiFontLarge;
 
 		// grab info to do with the text
-		char* buildingName = Building::buildingNames[b->getType()];
+		const char* buildingName = Building::buildingNames[b->getType()];
 		float titleWidth = titleFont->getStringWidth(buildingName);
 		float titleHeight = titleFont->getStringHeight(buildingName);
 
@@ -366,16 +325,16 @@ void Game::draw()
 			mouseScreen.getX() + boxPadding, mouseScreen.getY() - boxPadding - titleHeight);
 
 		// power icon
-		if (mouseOver->hasPower())
+		if (tiles->hasPower(mouseOverX, mouseOverY))
 			m_2dRenderer->setRenderColour(0, 1, 0);
 		else
 			m_2dRenderer->setRenderColour(1, 0, 0);
-		m_2dRenderer->drawSprite(m_powerIcon, mouseScreen.getX() + iconWidth / 2.0f,
+		m_powerIcon->draw(m_2dRenderer, mouseScreen.getX() + iconWidth / 2.0f,
 			mouseScreen.getY() - iconHeight - titleHeight);
 
 		// temp pollution value
 		char polValue[32];
-		sprintf_s(polValue, 32, "%d", m_tileManager->getTile(mouseOverX, mouseOverY)->getPollution());
+		sprintf_s(polValue, 32, "%.0f", tiles->getPollution(mouseOverX, mouseOverY));
 		m_2dRenderer->setRenderColour(1, 1, 1);
 		m_2dRenderer->drawText(titleFont, polValue,
 			mouseScreen.getX() + iconWidth, mouseScreen.getY() - iconHeight - titleHeight - 10);
@@ -444,13 +403,13 @@ void Game::drawTileRect(int left, int top, int right, int bottom)
 
 	// grab the world positions of the bounds
 	Vector2 topLeft =
-		m_tileManager->getTileWorldPosition(dragMinX, dragMinY);
+		getTileManager()->getTileWorldPosition(dragMinX, dragMinY);
 	Vector2 topRight =
-		m_tileManager->getTileWorldPosition(dragMaxX + 1, dragMinY);
+		getTileManager()->getTileWorldPosition(dragMaxX + 1, dragMinY);
 	Vector2 bottomRight =
-		m_tileManager->getTileWorldPosition(dragMaxX + 1, dragMaxY);
+		getTileManager()->getTileWorldPosition(dragMaxX + 1, dragMaxY);
 	Vector2 bottomLeft =
-		m_tileManager->getTileWorldPosition(dragMinX, dragMaxY);
+		getTileManager()->getTileWorldPosition(dragMinX, dragMaxY);
 
 	// adjust so the lines line up with the borders of the tile sprites
 	const float xOffset = TILE_WIDTH / 2.0f;
@@ -504,26 +463,17 @@ void Game::doScreenShake(float amt)
 // -------------------------------
 //   particle spawning functions:
 
-void Game::spawnSmokeParticle(Vector2& pos)
+void Game::spawnSmokeParticle(const Vector2& pos)
 {
-	if (m_particles->getCount() >= MAX_PARTICLES)
-		return;
-	auto p = new SmokeParticle(this, pos);
-	m_particles->add(p);
+	m_particles->spawnSmoke(pos);
 }
 
-void Game::spawnPollutionParticle(Vector2& pos)
+void Game::spawnPollutionParticle(const Vector2& pos)
 {
-	if (m_particles->getCount() >= MAX_PARTICLES)
-		return;
-	auto p = new PollutionParticle(this, pos);
-	m_particles->add(p);
+	m_particles->spawnPollution(pos);
 }
 
-void Game::spawnTextParticle(Vector2& pos, std::string text)
+void Game::spawnTextParticle(const Vector2& pos, std::string text)
 {
-	if (m_particles->getCount() >= MAX_PARTICLES)
-		return;
-	auto p = new TextParticle(this, pos, text);
-	m_particles->add(p);
+	m_particles->spawnText(pos, text.c_str());
 }
@@ -6,32 +6,18 @@
 #include "Application.h"
 
 #include "vector2.h"
+#include "simulation.h"
 
-#define TILE_WIDTH 132
-#define TILE_HEIGHT 99
-
-#define WORLD_WIDTH 64
-#define WORLD_HEIGHT 64
-
-#define MAX_PARTICLES 4096
-
-template <class T>
-class DArray;
+// where the profiler's recording is written on F12 and when quitting
+#define PROFILE_FILENAME "profile.json"
 
 class Camera;
-class Tile;
-class Particle;
+class ParticleSystem;
 class Vector2;
+struct Sprite;
 
-class ImageManager;
-class SaveManager;
 class UiManager;
 
-class Building;
-class BuildingManager;
-class RoadManager;
-class TileManager;
-
 // place modes are the modes the player can switch between to place
 //   different kinds of things
 // building mode lets you place buildings and zone mode lets you set zones
@@ -53,10 +39,6 @@ enum ViewMode
 	VIEWMODE_ROADS = 0b00001000
 };
 
-// typedef these so it's easier to type
-typedef DArray<Building*> BuildingList;
-typedef DArray<Particle*> ParticleList;
-
 class Game : public aie::Application
 {
 public:
@@ -79,7 +61,7 @@ public:
 	void update(float deltaTime) override;
 	void draw() override;
 
-	Vector2& getMapStart() { return m_mapStart; }
+	Vector2& getMapStart() { return m_simulation->getMapStart(); }
 
 	// mouse-related functions
 	Vector2 getMouseWorldPosition();
@@ -89,9 +71,9 @@ public:
 	void drawTileRect(int left, int top, int right, int bottom);
 
 	// money-related functions
-	int  getMoney() { return m_money; }
-	void setMoney(int money) { m_money = money; }
-	void addMoney(int money) { m_money += money; }
+	int  getMoney() { return m_simulation->getMoney(); }
+	void setMoney(int money) { m_simulation->setMoney(money); }
+	void addMoney(int money) { m_simulation->addMoney(money); }
 
 	// place mode related functions
 	PlaceMode getPlaceMode() { return m_placeMode; }
@@ -104,42 +86,40 @@ public:
 	void toggleViewMode(ViewMode mode);
 
 	// particle stuff
-	void spawnSmokeParticle(Vector2& pos);
-	void spawnPollutionParticle(Vector2& pos);
-	void spawnTextParticle(Vector2& pos, std::string text);
+	void spawnSmokeParticle(const Vector2& pos);
+	void spawnPollutionParticle(const Vector2& pos);
+	void spawnTextParticle(const Vector2& pos, std::string text);
 	void doScreenShake(float amt);
 
 	// getters for all of the managers
-	ImageManager*		getImageManager() { return m_imageManager; }
+	// everything except the UI lives in the simulation
+	Simulation*			getSimulation() { return m_simulation; }
+	CityStats*			getStats() { return m_simulation->getStats(); }
+	ImageManager*		getImageManager() { return m_simulation->getImageManager(); }
 	UiManager*			getUiManager() { return m_uiManager; }
-	BuildingManager*	getBuildingManager() { return m_buildingManager; }
-	RoadManager*		getRoadManager() { return m_roadManager; }
-	SaveManager*		getSaveManager() { return m_saveManager; }
-	TileManager*		getTileManager() { return m_tileManager; }
+	BuildingManager*	getBuildingManager() { return m_simulation->getBuildingManager(); }
+	RoadManager*		getRoadManager() { return m_simulation->getRoadManager(); }
+	SaveManager*		getSaveManager() { return m_simulation->getSaveManager(); }
+	TileManager*		getTileManager() { return m_simulation->getTileManager(); }
+	PowerManager*		getPowerManager() { return m_simulation->getPowerManager(); }
+	PollutionManager*	getPollutionManager() { return m_simulation->getPollutionManager(); }
+	Random&				getRandom(RandomStream stream) { return m_simulation->getRandom(stream); }
 
 protected:
 	aie::Renderer2D*	m_2dRenderer;
 	Camera*				m_camera;
 
-	// map/world-related stuff
-	Vector2				m_mapStart;
-	Tile***				m_tiles;
-	BuildingList*		m_buildings;
-	ParticleList*		m_particles;
+	// the world and everything in it
+	Simulation*			m_simulation;
+
+	ParticleSystem*		m_particles;
 
 	// icon shown in power viewmode
-	aie::Texture*		m_powerIcon;
+	Sprite*				m_powerIcon;
 
-	// I'm so sorry
-	ImageManager*		m_imageManager;
 	UiManager*			m_uiManager;
-	BuildingManager*	m_buildingManager;
-	RoadManager*		m_roadManager;
-	SaveManager*		m_saveManager;
-	TileManager*		m_tileManager;
 
 	// gameplay variables
 	PlaceMode			m_placeMode;
 	ViewMode			m_viewMode;
-	int					m_money;
 };
\ No newline at end of file
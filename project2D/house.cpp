@@ -1,10 +1,10 @@
 #include "house.h"
 
-#include "game.h"
+#include "simulation.h"
 #include "imagemanager.h"
 
-House::House(Game* game, int x, int y)
-	: Building(game, x, y)
+House::House(Simulation* sim, int x, int y)
+	: Building(sim, x, y)
 {
 	m_type = BUILDINGTYPE_HOUSE;
 	m_buildStyle = BUILDSTYLE_FORBIDDEN;
@@ -14,7 +14,7 @@ House::House(Game* game, int x, int y)
 	m_powerSpreadRange = 0;
 	m_shakesCamera = false;
 
-	m_texture = m_game->getImageManager()->getTexture("buildings/house");
+	m_sprite = m_sim->getImageManager()->getSprite(SPRITE_HOUSE);
 }
 
 void House::draw(aie::Renderer2D* renderer)
@@ -24,6 +24,6 @@ void House::draw(aie::Renderer2D* renderer)
 
 	const float xOrigin = 0.5f;
 	const float yOrigin = 0.0f;
-	renderer->drawSprite(m_texture, m_worldPos.getX(),
-		m_worldPos.getY() + m_altitude - 3, 0, 0, 0, 0, xOrigin, yOrigin);
+	m_sprite->draw(renderer, m_worldPos.getX(),
+		m_worldPos.getY() + m_altitude - 3, 0, 0, xOrigin, yOrigin);
 }
@@ -5,7 +5,7 @@
 class House : public Building
 {
 public:
-	House(Game* game, int x, int y);
+	House(Simulation* sim, int x, int y);
 
 	void draw(aie::Renderer2D* renderer) override;
 };
\ No newline at end of file
@@ -1,46 +1,251 @@
 #include "imagemanager.h"
 
-ImageManager::ImageManager() {}
+#include <cstdio>
+#include <vector>
+#include <fstream>
+
+#include "Profiler.h"
+
+#include "textureatlas.h"
+
+// where every texture is, from its name
+static const char* fileNameTemplate = "./textures/%s.png";
+
+const char* ImageManager::m_spriteNames[SPRITE_COUNT] =
+{
+	"buildings/factory",			// SPRITE_FACTORY
+	"buildings/house",				// SPRITE_HOUSE
+	"buildings/powerplant",			// SPRITE_POWERPLANT
+	"buildings/powerpole",			// SPRITE_POWERPOLE
+	"buildings/road_intersection",	// SPRITE_ROAD_INTERSECTION
+	"buildings/road_left",			// SPRITE_ROAD_LEFT
+	"buildings/road_right",			// SPRITE_ROAD_RIGHT
+	"buildings/shop",				// SPRITE_SHOP
+	"icons/building",				// SPRITE_ICON_BUILDING
+	"icons/demolish",				// SPRITE_ICON_DEMOLISH
+	"icons/power",					// SPRITE_ICON_POWER
+	"icons/powerplant",				// SPRITE_ICON_POWERPLANT
+	"icons/powerpole",				// SPRITE_ICON_POWERPOLE
+	"icons/road",					// SPRITE_ICON_ROAD
+	"icons/zone",					// SPRITE_ICON_ZONE
+	"mouth_closed",					// SPRITE_MOUTH_CLOSED
+	"mouth_open",					// SPRITE_MOUTH_OPEN
+	"pollution",					// SPRITE_POLLUTION
+	"smoke",						// SPRITE_SMOKE
+	"tiles/grass_flat",				// SPRITE_GRASS
+};
+
+ImageManager::ImageManager(bool loadTextures)
+	: m_loadTextures(loadTextures)
+{
+	m_atlas = nullptr;
+	m_placeholder = nullptr;
+	m_pendingCount = 0;
+
+	// no window means nothing to draw with, so don't load anything
+	// the names still get their handles, so they're the same either way
+	if (!m_loadTextures)
+	{
+		for (int i = 0; i < SPRITE_COUNT; ++i)
+			internSprite(m_spriteNames[i], nullptr);
+		return;
+	}
+
+	// grab the names of everything we want in the atlas
+	std::vector<std::string> names;
+	std::ifstream manifest(ATLAS_MANIFEST);
+	std::string line;
+	while (std::getline(manifest, line))
+	{
+		// ignore any stray windows line endings
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (!line.empty())
+			names.push_back(line);
+	}
+
+	if (names.empty())
+		printf("No atlas manifest, textures will be loaded one by one\n");
+
+	unsigned char blank[4] = { 0, 0, 0, 0 };
+	m_placeholder = new aie::Texture(1, 1, aie::Texture::RGBA, blank);
+
+	std::map<std::string, Sprite> packed;
+	m_atlas = new TextureAtlas();
+	m_atlas->pack(names, fileNameTemplate, packed);
+
+	// the SpriteIds go first so their handles match
+	for (int i = 0; i < SPRITE_COUNT; ++i)
+		internSprite(m_spriteNames[i], &packed);
+	// anything that didn't fit in the atlas still gets warmed up now,
+	//   rather than the first time it's asked for
+	for (auto& name : names)
+		internSprite(name, &packed);
+}
 
 ImageManager::~ImageManager()
 {
-	// destroy all textures
-	for (auto t : m_textures)
+	// the decoding jobs write into us, so they have to finish first
+	if (m_loadTextures)
+		aie::JobSystem::getInstance()->wait(&m_decoding);
+	for (auto& decoded : m_uploads)
 	{
-		aie::Texture* tex = t.second;
+		if (decoded.pixels)
+			aie::Texture::freePixels(decoded.pixels);
+	}
 
+	// destroy all textures
+	for (auto tex : m_textures)
 		delete tex;
-	}
+
+	delete m_placeholder;
+	delete m_atlas;
 }
 
-// gets a texture by name, and if it doesn't exist, tries to load it and 
-// store it into our map
-aie::Texture* ImageManager::getTexture(char* name)
+int ImageManager::getHandle(const char* name)
 {
-	const char* fileNameTemplate = "./textures/%s.png";
+	auto found = m_handles.find(name);
+	if (found != m_handles.end())
+		return found->second;
 
-	aie::Texture* loaded = m_textures[name];
-	if (loaded == nullptr)
+	// texture doesn't exist - start loading it
+	return internSprite(name, nullptr);
+}
+
+Sprite* ImageManager::getSprite(const int handle)
+{
+	// no window means nothing to draw with
+	if (!m_loadTextures)
+		return nullptr;
+
+	return &m_sprites[handle];
+}
+
+Sprite* ImageManager::getSprite(const char* name)
+{
+	return getSprite(getHandle(name));
+}
+
+void ImageManager::update()
+{
+	if (m_pendingCount == 0)
+		return;
+
+	PROFILE_ZONE("ImageManager::update");
+
+	// with no worker threads, nothing gets decoded unless we wait for it
+	aie::JobSystem* jobs = aie::JobSystem::getInstance();
+	if (jobs->getThreadCount() <= 1)
+		jobs->wait(&m_decoding);
+
+	// take as many as fit in the budget, leaving the rest for next frame
+	std::vector<DecodedTexture> ready;
 	{
-		const int fileNameSize = 512;
-		// texture doesn't exist - try loading
-		char fileName[fileNameSize];
-		sprintf_s(fileName, fileNameSize, fileNameTemplate, name);
-		aie::Texture* tex = new aie::Texture(fileName);
-		if (tex != nullptr)
+		std::lock_guard<std::mutex> lock(m_uploadLock);
+		int bytes = 0;
+		size_t count = 0;
+		while (count < m_uploads.size() && (count == 0
+			|| bytes < TEXTURE_UPLOAD_BUDGET))
 		{
-			m_textures[name] = tex;
-			return tex;
+			const DecodedTexture& decoded = m_uploads[count];
+			// the format is also how many bytes each pixel takes
+			bytes += decoded.width * decoded.height * decoded.format;
+			count++;
 		}
-		else
+		ready.assign(m_uploads.begin(), m_uploads.begin() + count);
+		m_uploads.erase(m_uploads.begin(), m_uploads.begin() + count);
+	}
+
+	for (auto& decoded : ready)
+		uploadTexture(decoded);
+}
+
+int ImageManager::internSprite(const std::string& name,
+	const std::map<std::string, Sprite>* packed)
+{
+	auto found = m_handles.find(name);
+	if (found != m_handles.end())
+		return found->second;
+
+	int handle = (int)m_sprites.size();
+	m_handles[name] = handle;
+	m_sprites.emplace_back();
+
+	if (!m_loadTextures)
+		return handle;
+
+	if (packed)
+	{
+		auto inAtlas = packed->find(name);
+		if (inAtlas != packed->end())
 		{
-			// wasn't found!
-			printf("Texture named %s was not found!\n", name);
-			return nullptr;
+			m_sprites[handle] = inAtlas->second;
+			return handle;
 		}
 	}
-	else
+
+	requestTexture(name, handle);
+	return handle;
+}
+
+void ImageManager::requestTexture(const std::string& name, const int handle)
+{
+	// a texture on its own uses the whole thing
+	// the placeholder's size is left at 0, so it's drawn at its own size of
+	//   one invisible pixel
+	Sprite& sprite = m_sprites[handle];
+	sprite.texture = m_placeholder;
+	sprite.uvX = 0.0f;
+	sprite.uvY = 0.0f;
+	sprite.uvW = 1.0f;
+	sprite.uvH = 1.0f;
+	sprite.width = 0;
+	sprite.height = 0;
+
+	const int fileNameSize = 512;
+	char fileName[fileNameSize];
+	snprintf(fileName, fileNameSize, fileNameTemplate, name.c_str());
+
+	DecodedTexture decoded;
+	decoded.name = name;
+	decoded.fileName = fileName;
+	decoded.handle = handle;
+	decoded.pixels = nullptr;
+	decoded.width = 0;
+	decoded.height = 0;
+	decoded.format = aie::Texture::RGBA;
+
+	// decoded in the background so the main thread never picks one up while
+	//   it's waiting on the simulation's jobs in the middle of a frame
+	m_pendingCount++;
+	aie::JobSystem::getInstance()->runBackground([this, decoded]() mutable
 	{
-		return loaded;
+		decoded.pixels = aie::Texture::loadPixels(decoded.fileName.c_str(),
+			&decoded.width, &decoded.height, &decoded.format);
+
+		std::lock_guard<std::mutex> lock(m_uploadLock);
+		m_uploads.push_back(decoded);
+	}, &m_decoding);
+}
+
+void ImageManager::uploadTexture(DecodedTexture& decoded)
+{
+	m_pendingCount--;
+	if (decoded.pixels == nullptr)
+	{
+		// wasn't found! leave the placeholder so it draws as a blank instead
+		printf("Texture named %s was not found!\n", decoded.name.c_str());
+		return;
 	}
+
+	aie::Texture* tex = new aie::Texture();
+	tex->upload(decoded.fileName.c_str(), decoded.width, decoded.height,
+		decoded.format, decoded.pixels);
+	m_textures.push_back(tex);
+
+	// everyone holding the sprite sees the real texture from now on
+	Sprite& sprite = m_sprites[decoded.handle];
+	sprite.texture = tex;
+	sprite.width = tex->getWidth();
+	sprite.height = tex->getHeight();
 }
\ No newline at end of file
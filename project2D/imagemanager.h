@@ -1,28 +1,163 @@
 #pragma once
 
 #include <map>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "Texture.h"
+#include "JobSystem.h"
+
+#include "sprite.h"
+
+// list of textures to load when starting up, one per line
+// everything in it is packed into the atlas, and anything that can't be
+//   is streamed in on its own straight away
+#define ATLAS_MANIFEST "./textures/atlas.txt"
+// how many bytes of decoded pixels ImageManager::update sends to the GPU
+//   each frame, so lots of textures finishing at once don't cause a hitch
+// at least one texture is always sent, however big it is
+#define TEXTURE_UPLOAD_BUDGET (4 * 1024 * 1024)
+
+// every sprite the game asks for by itself, given their handles when the
+//   ImageManager is made, so getting one is just an index into a table
+enum SpriteId
+{
+	SPRITE_FACTORY = 0,
+	SPRITE_HOUSE,
+	SPRITE_POWERPLANT,
+	SPRITE_POWERPOLE,
+	SPRITE_ROAD_INTERSECTION,
+	SPRITE_ROAD_LEFT,
+	SPRITE_ROAD_RIGHT,
+	SPRITE_SHOP,
+	SPRITE_ICON_BUILDING,
+	SPRITE_ICON_DEMOLISH,
+	SPRITE_ICON_POWER,
+	SPRITE_ICON_POWERPLANT,
+	SPRITE_ICON_POWERPOLE,
+	SPRITE_ICON_ROAD,
+	SPRITE_ICON_ZONE,
+	SPRITE_MOUTH_CLOSED,
+	SPRITE_MOUTH_OPEN,
+	SPRITE_POLLUTION,
+	SPRITE_SMOKE,
+	SPRITE_GRASS,
+
+	SPRITE_COUNT // the total number of sprite ids
+};
+
+class TextureAtlas;
 
 class ImageManager
 {
 public:
-	ImageManager();
+	//------------------------------------------------------------------------
+	// Packs every texture listed in ATLAS_MANIFEST into the atlas
+	//
+	// Param:
+	//			loadTextures: whether or not textures should actually be 
+	//						  loaded - if not, getSprite always returns 
+	//						  nullptr (used when running without a window)
+	//------------------------------------------------------------------------
+	explicit ImageManager(bool loadTextures = true);
 	~ImageManager();
 
 	//------------------------------------------------------------------------
-	// Gets a texture with a specified name
-	// If the texture has been loaded before, get that
-	// If not, load the texture and store it for future use
+	// Gets the handle of a picture with a specified name, which stays the
+	//   same for as long as the ImageManager is around
+	// A name seen for the first time is given the next handle, and if it's
+	//   not in the atlas its texture is decoded on another thread
+	// Until update has sent it to the GPU, the sprite draws as a blank
+	//   placeholder, then the same sprite is filled in
+	// SpriteIds are already handles, so they don't need this
 	//
 	// Param: 
 	//			name: the name of the texture to get
 	// Return: 
-	//			pointer to the texture - nullptr if no texture could be loaded
+	//			the picture's handle
+	//------------------------------------------------------------------------
+	int getHandle(const char* name);
+	//------------------------------------------------------------------------
+	// Gets a picture from its handle, without any looking up by name
+	//
+	// Param: 
+	//			handle: a SpriteId or something given by getHandle
+	// Return: 
+	//			pointer to the sprite - nullptr if running without a window
 	//------------------------------------------------------------------------
-	aie::Texture* getTexture(char* name);
+	Sprite* getSprite(int handle);
+	//------------------------------------------------------------------------
+	// Gets a picture with a specified name, the same as
+	//   getSprite(getHandle(name))
+	// Looks the name up every time, so keep the result or the handle
+	//
+	// Param: 
+	//			name: the name of the texture to get
+	// Return: 
+	//			pointer to the sprite - nullptr if running without a window
+	//------------------------------------------------------------------------
+	Sprite* getSprite(const char* name);
+	//------------------------------------------------------------------------
+	// Called every frame
+	// Sends textures which have finished decoding to the GPU, up to
+	//   TEXTURE_UPLOAD_BUDGET bytes of them
+	//------------------------------------------------------------------------
+	void update();
+	//------------------------------------------------------------------------
+	// Gets how many textures are still being decoded or uploaded
+	//
+	// Return:
+	//			the number of sprites still showing the placeholder
+	//------------------------------------------------------------------------
+	int getPendingCount() const { return m_pendingCount; }
 private:
-	// where textures are stored
-	std::map<std::string, aie::Texture*> m_textures;
+	// a texture decoded on another thread, waiting to be sent to the GPU
+	struct DecodedTexture
+	{
+		std::string		name;
+		std::string		fileName;
+		int				handle;
+		// nullptr if the file couldn't be loaded
+		unsigned char*	pixels;
+		unsigned int	width, height;
+		aie::Texture::Format format;
+	};
+
+	// the names of the SpriteIds
+	static const char* m_spriteNames[SPRITE_COUNT];
+
+	// every picture handed out so far, by handle
+	// a deque never moves what's already in it, so the pointers handed out
+	//   stay good as more are added
+	std::deque<Sprite> m_sprites;
+	// the handle of every name seen so far
+	std::map<std::string, int> m_handles;
+	// textures which weren't in the atlas and had to be loaded on their own
+	std::vector<aie::Texture*> m_textures;
+
+	TextureAtlas* m_atlas;
+	// a transparent pixel drawn in place of textures still being loaded
+	aie::Texture* m_placeholder;
+
+	// the decoding jobs, and the textures they've finished
+	aie::JobCounter m_decoding;
+	std::mutex m_uploadLock;
+	std::vector<DecodedTexture> m_uploads;
+	// textures asked for which haven't been uploaded yet
+	int m_pendingCount;
+
+	// false when there's no window to upload textures to
+	bool m_loadTextures;
+
+	// gives a name the next handle and finds its picture, either in the
+	//   packed atlas pictures or by starting to decode it
+	// does nothing if the name already has a handle
+	int internSprite(const std::string& name,
+		const std::map<std::string, Sprite>* packed);
+	// gives a sprite the placeholder and starts decoding its texture
+	void requestTexture(const std::string& name, int handle);
+	// makes a texture out of decoded pixels and fills in its sprite
+	void uploadTexture(DecodedTexture& decoded);
 };
\ No newline at end of file
@@ -3,10 +3,76 @@
 #include <stdlib.h>  
 #include <crtdbg.h>  
 
+#include <cstring>
+
+#include "Profiler.h"
+#include "JobSystem.h"
+
 #include "game.h"
+#include "darray.h"
+#include "benchmark.h"
+#include "savemanager.h"
+#include "buildingmanager.h"
+
+// loads the save file and runs it without a window as fast as possible
+// used like: Project2D.exe -headless [ticks] [world size]
+// giving a world size starts an empty world of that size instead of loading
+int runHeadless(int ticks, int worldSize)
+{
+	aie::JobSystem::create();
+
+	Simulation* sim;
+	if (worldSize > 0)
+	{
+		sim = new Simulation(nullptr, worldSize, worldSize);
+	}
+	else
+	{
+		sim = new Simulation();
+		if (!sim->getSaveManager()->loadData())
+			printf("No save to load, starting from an empty world\n");
+	}
+
+	for (int i = 0; i < ticks; ++i)
+		sim->tick();
+
+	printf("Ran %u ticks (%.1f seconds) on a %dx%d world: $%d, %d buildings\n",
+		sim->getTickCount(), sim->getTickCount() * sim->getTickTime(),
+		sim->getWorldWidth(), sim->getWorldHeight(),
+		sim->getMoney(), sim->getBuildingManager()->getBuildings()->getCount());
 
-int main()
+	PROFILE_DUMP(PROFILE_FILENAME);
+
+	delete sim;
+	aie::JobSystem::destroy();
+	PROFILE_SHUTDOWN();
+
+	_CrtDumpMemoryLeaks();
+	return 0;
+}
+
+int main(int argc, char** argv)
 {
+	if (argc > 1 && strcmp(argv[1], "-headless") == 0)
+	{
+		// default to a minute of game time
+		int ticks = SIM_TICK_RATE * 60;
+		if (argc > 2)
+			ticks = atoi(argv[2]);
+		// and to loading the save
+		int worldSize = 0;
+		if (argc > 3)
+		{
+			worldSize = atoi(argv[3]);
+			if (worldSize > MAX_WORLD_SIZE)
+				worldSize = MAX_WORLD_SIZE;
+		}
+		return runHeadless(ticks, worldSize);
+	}
+
+	if (argc > 1 && strcmp(argv[1], "-benchmark") == 0)
+		return runBenchmarks(argc > 2 ? argv[2] : nullptr);
+
 	// allocation
 	auto app = new Game();
 
@@ -15,6 +81,7 @@ int main()
 
 	// deallocation
 	delete app;
+	PROFILE_SHUTDOWN();
 
 	// log any detected leaks
 	_CrtDumpMemoryLeaks();
@@ -0,0 +1,273 @@
+#include "particlesystem.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include "Font.h"
+#include "Profiler.h"
+
+#include "game.h"
+#include "sprite.h"
+#include "random.h"
+#include "imagemanager.h"
+
+ParticlePool::ParticlePool(int capacity, bool hasText)
+	: count(0), capacity(capacity), newStart(0)
+{
+	// everything is allocated up front so spawning never allocates
+	posX = new float[capacity];
+	posY = new float[capacity];
+	velX = new float[capacity];
+	velY = new float[capacity];
+	rotation = new float[capacity];
+	rotateVelocity = new float[capacity];
+	opacity = new float[capacity];
+	text = hasText ? new char[capacity * TEXT_PARTICLE_LENGTH] : nullptr;
+}
+
+ParticlePool::~ParticlePool()
+{
+	delete[] posX;
+	delete[] posY;
+	delete[] velX;
+	delete[] velY;
+	delete[] rotation;
+	delete[] rotateVelocity;
+	delete[] opacity;
+	delete[] text;
+}
+
+int ParticlePool::add(const Vector2& pos)
+{
+	if (count >= capacity)
+		return -1;
+
+	int i = count++;
+	posX[i] = pos.getX();
+	posY[i] = pos.getY();
+	velX[i] = 0.0f;
+	velY[i] = 0.0f;
+	rotation[i] = 0.0f;
+	rotateVelocity[i] = 0.0f;
+	opacity[i] = 1.0f;
+	return i;
+}
+
+void ParticlePool::removeDead()
+{
+	// going backwards means whatever gets swapped in has already been checked
+	for (int i = count - 1; i >= 0; --i)
+	{
+		if (opacity[i] > 0.0f)
+			continue;
+
+		int last = --count;
+		posX[i] = posX[last];
+		posY[i] = posY[last];
+		velX[i] = velX[last];
+		velY[i] = velY[last];
+		rotation[i] = rotation[last];
+		rotateVelocity[i] = rotateVelocity[last];
+		opacity[i] = opacity[last];
+		if (text)
+		{
+			memcpy(text + i * TEXT_PARTICLE_LENGTH,
+				text + last * TEXT_PARTICLE_LENGTH, TEXT_PARTICLE_LENGTH);
+		}
+	}
+
+	newStart = count;
+}
+
+ParticleSystem::ParticleSystem(Game* game)
+	: m_game(game), m_smoke(MAX_SMOKE_PARTICLES),
+	m_pollution(MAX_POLLUTION_PARTICLES), m_text(MAX_TEXT_PARTICLES, true)
+{
+	m_smokeSprite = game->getImageManager()->getSprite(SPRITE_SMOKE);
+	m_pollutionSprite = game->getImageManager()->getSprite(SPRITE_POLLUTION);
+}
+
+void ParticleSystem::update(float delta)
+{
+	PROFILE_ZONE("ParticleSystem::update");
+
+	randomiseNew();
+
+	// every kind is moved in batches across the job system, and each pool is
+	//   tidied up as soon as its own batches are done
+	// (kept as std::functions since the jobs hold on to them by reference)
+	std::function<void(int, int)> moveSmoke = [&](int start, int end)
+	{
+		updateSmoke(delta, start, end);
+	};
+	std::function<void(int, int)> movePollution = [&](int start, int end)
+	{
+		updatePollution(delta, start, end);
+	};
+	std::function<void(int, int)> moveText = [&](int start, int end)
+	{
+		updateText(delta, start, end);
+	};
+
+	aie::JobCounter smokeMoved, pollutionMoved, textMoved;
+	aie::JobCounter done;
+	queuePoolUpdate(m_smoke, moveSmoke, &smokeMoved, &done);
+	queuePoolUpdate(m_pollution, movePollution, &pollutionMoved, &done);
+	queuePoolUpdate(m_text, moveText, &textMoved, &done);
+
+	aie::JobSystem::getInstance()->wait(&done);
+}
+
+void ParticleSystem::queuePoolUpdate(ParticlePool& pool,
+	const std::function<void(int start, int end)>& move,
+	aie::JobCounter* moved, aie::JobCounter* done)
+{
+	aie::JobSystem* jobs = aie::JobSystem::getInstance();
+
+	const int count = pool.count;
+	for (int start = 0; start < count; start += PARTICLES_PER_JOB)
+	{
+		int end = std::min(start + PARTICLES_PER_JOB, count);
+		jobs->run([&move, start, end]() { move(start, end); }, moved);
+	}
+
+	jobs->run([&pool]() { pool.removeDead(); }, done, moved);
+}
+
+void ParticleSystem::draw(aie::Renderer2D* renderer)
+{
+	drawPool(renderer, m_smoke, m_smokeSprite);
+	drawPool(renderer, m_pollution, m_pollutionSprite);
+
+	for (int i = 0; i < m_text.count; ++i)
+	{
+		renderer->setRenderColour(0.5f, 0.0f, 0.0f, m_text.opacity[i]);
+		renderer->drawText(m_game->m_uiFontLarge,
+			m_text.text + i * TEXT_PARTICLE_LENGTH,
+			m_text.posX[i], m_text.posY[i]);
+	}
+}
+
+void ParticleSystem::spawnSmoke(const Vector2& pos)
+{
+	// the random values are filled in by randomiseNew
+	m_smoke.add(pos);
+}
+
+void ParticleSystem::spawnPollution(const Vector2& pos)
+{
+	// the random values are filled in by randomiseNew
+	m_pollution.add(pos);
+}
+
+void ParticleSystem::spawnText(const Vector2& pos, const char* text)
+{
+	int i = m_text.add(pos);
+	if (i < 0)
+		return;
+
+	// text just floats straight up
+	m_text.velY[i] = 100.0f;
+
+	char* dest = m_text.text + i * TEXT_PARTICLE_LENGTH;
+	// cuts off anything too long, the same as strncpy_s with _TRUNCATE
+	snprintf(dest, TEXT_PARTICLE_LENGTH, "%s", text);
+}
+
+int ParticleSystem::getCount() const
+{
+	return m_smoke.count + m_pollution.count + m_text.count;
+}
+
+void ParticleSystem::randomiseNew()
+{
+	Random& random = m_game->getRandom(RANDOMSTREAM_PARTICLES);
+
+	ParticlePool& smoke = m_smoke;
+	int start = smoke.newStart;
+	int count = smoke.count - start;
+	if (count > 0)
+	{
+		// random velocities
+		random.fill(smoke.velX + start, count, -100.0f, 100.0f);
+		random.fill(smoke.velY + start, count, 40.0f, 200.0f);
+
+		// add some opacity so there's some variance in
+		//   how long it takes to disappear
+		random.fill(smoke.opacity + start, count, 1.0f, 1.8f);
+
+		// and random rotation
+		random.fill(smoke.rotateVelocity + start, count, -3.0f, 3.0f);
+	}
+
+	ParticlePool& pollution = m_pollution;
+	start = pollution.newStart;
+	count = pollution.count - start;
+	if (count > 0)
+	{
+		// random velocities
+		random.fill(pollution.velX + start, count, -10.0f, 10.0f);
+		random.fill(pollution.velY + start, count, 40.0f, 100.0f);
+
+		// and random rotation
+		random.fill(pollution.rotateVelocity + start, count, -3.0f, 3.0f);
+	}
+}
+
+void ParticleSystem::updateSmoke(const float delta, const int start,
+	const int end)
+{
+	ParticlePool& p = m_smoke;
+	const float drag = 1.0f - delta;
+	for (int i = start; i < end; ++i)
+	{
+		// particle will be removed once opacity reaches 0
+		p.opacity[i] -= delta * 1.5f;
+		p.rotation[i] += p.rotateVelocity[i] * delta;
+
+		// slows down as it rises
+		p.velX[i] *= drag;
+		p.velY[i] *= drag;
+		p.posX[i] += p.velX[i] * delta;
+		p.posY[i] += p.velY[i] * delta;
+	}
+}
+
+void ParticleSystem::updatePollution(const float delta, const int start,
+	const int end)
+{
+	ParticlePool& p = m_pollution;
+	for (int i = start; i < end; ++i)
+	{
+		// particle will be removed once opacity reaches 0
+		p.opacity[i] -= delta * 0.8f;
+		p.rotation[i] += p.rotateVelocity[i] * delta;
+
+		p.posX[i] += p.velX[i] * delta;
+		p.posY[i] += p.velY[i] * delta;
+	}
+}
+
+void ParticleSystem::updateText(const float delta, const int start,
+	const int end)
+{
+	ParticlePool& p = m_text;
+	for (int i = start; i < end; ++i)
+	{
+		// particle will be removed once opacity reaches 0
+		p.opacity[i] -= delta * 0.8f;
+
+		p.posY[i] += p.velY[i] * delta;
+	}
+}
+
+void ParticleSystem::drawPool(aie::Renderer2D* renderer,
+	const ParticlePool& pool, const Sprite* sprite)
+{
+	for (int i = 0; i < pool.count; ++i)
+	{
+		renderer->setRenderColour(1, 1, 1, pool.opacity[i]);
+		sprite->draw(renderer, pool.posX[i], pool.posY[i], pool.rotation[i]);
+	}
+}
\ No newline at end of file
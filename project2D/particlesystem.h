@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Renderer2D.h"
+#include "JobSystem.h"
+
+#include "vector2.h"
+
+// how many of each kind of particle can be alive at once
+#define MAX_SMOKE_PARTICLES 2048
+#define MAX_POLLUTION_PARTICLES 2048
+#define MAX_TEXT_PARTICLES 64
+// longest text a text particle can show, including the null terminator
+#define TEXT_PARTICLE_LENGTH 32
+// how many particles each job moves at once
+#define PARTICLES_PER_JOB 512
+
+// Forward declares
+class Game;
+struct Sprite;
+
+// every particle of one kind, with each value kept in its own array
+// particles are packed at the front, so updating is a straight run over
+//   [0, count) with no pointers to chase and no virtual calls
+struct ParticlePool
+{
+	ParticlePool(int capacity, bool hasText = false);
+	~ParticlePool();
+
+	// we don't expect ParticlePool to be copied/moved
+	ParticlePool(const ParticlePool& pp) = default;
+	ParticlePool(ParticlePool&& pp) = default;
+	ParticlePool& operator=(ParticlePool& pp) = default;
+	ParticlePool& operator=(ParticlePool&& pp) = default;
+
+	//------------------------------------------------------------------------
+	// Takes the next free slot and resets it
+	//
+	// Return:
+	//			index of the new particle, or -1 if the pool is full
+	//------------------------------------------------------------------------
+	int add(const Vector2& pos);
+	//------------------------------------------------------------------------
+	// Removes every particle which has faded out by moving the last
+	//   particle into its slot, so nothing else has to be shuffled along
+	//------------------------------------------------------------------------
+	void removeDead();
+
+	int		count;
+	int		capacity;
+	// particles from here up to count were added since the last update, so
+	//   haven't had their random values filled in yet
+	int		newStart;
+
+	// transform values
+	float*	posX;
+	float*	posY;
+	float*	velX;
+	float*	velY;
+	float*	rotation;
+	float*	rotateVelocity;
+	// opacity is also used as the lifetime of the particle
+	float*	opacity;
+	// TEXT_PARTICLE_LENGTH characters per particle, or nullptr if this
+	//   kind of particle doesn't show text
+	char*	text;
+};
+
+// looks after every particle in the game
+// each kind of particle gets its own pool and its own update loop
+class ParticleSystem
+{
+public:
+	//------------------------------------------------------------------------
+	// Param:
+	//			game: pointer to our Game so we can access everything we need
+	//------------------------------------------------------------------------
+	ParticleSystem(Game* game);
+
+	// we don't expect ParticleSystem to be copied/moved
+	ParticleSystem(const ParticleSystem& ps) = default;
+	ParticleSystem(ParticleSystem&& ps) = default;
+	ParticleSystem& operator=(ParticleSystem& ps) = default;
+	ParticleSystem& operator=(ParticleSystem&& ps) = default;
+
+	//------------------------------------------------------------------------
+	// Moves and fades every particle, then removes the faded ones
+	//
+	// Param:
+	//			delta: time in seconds since the last frame
+	//------------------------------------------------------------------------
+	void update(float delta);
+	//------------------------------------------------------------------------
+	// Draws every particle, one kind at a time
+	//
+	// Param:
+	//			renderer: a pointer to the Renderer2D we're using
+	//------------------------------------------------------------------------
+	void draw(aie::Renderer2D* renderer);
+
+	//------------------------------------------------------------------------
+	// Spawns a particle, doing nothing if there's no room for it
+	//
+	// Param:
+	//			pos:  where to spawn the particle
+	//			text: text to show, cut short if it's too long
+	//------------------------------------------------------------------------
+	void spawnSmoke(const Vector2& pos);
+	void spawnPollution(const Vector2& pos);
+	void spawnText(const Vector2& pos, const char* text);
+
+	//------------------------------------------------------------------------
+	// Gets how many particles are alive
+	//
+	// Return:
+	//			the number of particles of every kind
+	//------------------------------------------------------------------------
+	int getCount() const;
+private:
+	Game* m_game;
+
+	ParticlePool m_smoke;
+	ParticlePool m_pollution;
+	ParticlePool m_text;
+
+	Sprite* m_smokeSprite;
+	Sprite* m_pollutionSprite;
+
+	// gives every particle spawned since the last update its random values,
+	//   filling a whole array at a time
+	void randomiseNew();
+
+	// per-kind update loops, over the particles from start up to (not
+	//   including) end so a pool can be split between jobs
+	void updateSmoke(float delta, int start, int end);
+	void updatePollution(float delta, int start, int end);
+	void updateText(float delta, int start, int end);
+
+	// queues jobs to move a pool's particles a batch at a time, then one to
+	//   remove its faded particles once all of those have finished
+	void queuePoolUpdate(ParticlePool& pool,
+		const std::function<void(int start, int end)>& move,
+		aie::JobCounter* moved, aie::JobCounter* done);
+
+	// draws every particle in a pool with the same sprite
+	void drawPool(aie::Renderer2D* renderer, const ParticlePool& pool,
+		const Sprite* sprite);
+};
\ No newline at end of file
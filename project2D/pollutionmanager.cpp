@@ -0,0 +1,188 @@
+#include "pollutionmanager.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "Profiler.h"
+#include "JobSystem.h"
+
+#include "tilegrid.h"
+#include "simulation.h"
+
+// every x86 compiler we care about has SSE, anything else just gets the
+//   plain loops
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define POLLUTION_SSE
+#endif
+
+PollutionManager::PollutionManager(Simulation* sim)
+	: m_sim(sim)
+{
+	m_width = 0;
+	m_height = 0;
+
+	// linear falloff over a circle, kept to sixteenths so taking a stamp
+	//   away always exactly cancels out putting it down
+	const int range = POLLUTION_SPREAD_RANGE;
+	const int size = range * 2 + 1;
+	m_kernel.resize(size * size);
+	for (int y = -range; y <= range; ++y)
+	{
+		for (int x = -range; x <= range; ++x)
+		{
+			float dist = sqrtf((float)(x * x + y * y));
+			float weight = std::max(0.0f, 1.0f - dist / (range + 1));
+			m_kernel[(y + range) * size + (x + range)] =
+				floorf(weight * 16.0f + 0.5f) / 16.0f;
+		}
+	}
+}
+
+void PollutionManager::resize(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+
+	m_emission.assign(width * height, 0.0f);
+	m_spread.assign(width * height, 0.0f);
+	m_emptyRow.assign(width, 0.0f);
+}
+
+void PollutionManager::addEmitter(int x, int y, float amount)
+{
+	stampEmitter(x, y, amount);
+}
+
+void PollutionManager::removeEmitter(int x, int y, float amount)
+{
+	stampEmitter(x, y, -amount);
+}
+
+void PollutionManager::stampEmitter(int x, int y, float amount)
+{
+	const int range = POLLUTION_SPREAD_RANGE;
+	const int size = range * 2 + 1;
+
+	// only the part of the kernel that's on the map
+	int minX = std::max(x - range, 0);
+	int minY = std::max(y - range, 0);
+	int maxX = std::min(x + range, m_width - 1);
+	int maxY = std::min(y + range, m_height - 1);
+	if (minX > maxX || minY > maxY)
+		return;
+
+	for (int ty = minY; ty <= maxY; ++ty)
+	{
+		const float* kernel = &m_kernel[(ty - y + range) * size
+			+ (minX - x + range)];
+		float* emission = &m_emission[ty * m_width + minX];
+		for (int i = 0; i <= maxX - minX; ++i)
+			emission[i] += kernel[i] * amount;
+	}
+}
+
+void PollutionManager::step()
+{
+	PROFILE_ZONE("PollutionManager::step");
+
+	if (m_width <= 0 || m_height <= 0)
+		return;
+
+	// the columns need the rows above and below already spread, so every
+	//   row has to be done before any column is
+	aie::JobSystem* jobs = aie::JobSystem::getInstance();
+	jobs->parallelFor(m_height, POLLUTION_ROWS_PER_JOB,
+		[this](int startY, int endY) { spreadRows(startY, endY); });
+	jobs->parallelFor(m_height, POLLUTION_ROWS_PER_JOB,
+		[this](int startY, int endY) { spreadColumns(startY, endY); });
+}
+
+void PollutionManager::spreadRows(int startY, int endY)
+{
+	const float* pollution = m_sim->getTiles()->getPollutionData();
+	const int width = m_width;
+
+	// what's left on a tile, and what it gets from each side
+	const float keep = 1.0f - 2.0f * POLLUTION_DIFFUSION;
+	const float take = POLLUTION_DIFFUSION;
+
+	for (int y = startY; y < endY; ++y)
+	{
+		const float* in = pollution + y * width;
+		float* out = &m_spread[y * width];
+
+		// the tiles on the ends have nothing on one side
+		if (width == 1)
+		{
+			out[0] = in[0] * keep;
+			continue;
+		}
+		out[0] = in[0] * keep + in[1] * take;
+
+		int x = 1;
+#ifdef POLLUTION_SSE
+		const __m128 keep4 = _mm_set1_ps(keep);
+		const __m128 take4 = _mm_set1_ps(take);
+		for (; x + 4 < width; x += 4)
+		{
+			__m128 left = _mm_loadu_ps(in + x - 1);
+			__m128 centre = _mm_loadu_ps(in + x);
+			__m128 right = _mm_loadu_ps(in + x + 1);
+			__m128 sides = _mm_mul_ps(_mm_add_ps(left, right), take4);
+			_mm_storeu_ps(out + x, _mm_add_ps(_mm_mul_ps(centre, keep4), sides));
+		}
+#endif
+		for (; x < width - 1; ++x)
+			out[x] = in[x] * keep + (in[x - 1] + in[x + 1]) * take;
+
+		out[width - 1] = in[width - 1] * keep + in[width - 2] * take;
+	}
+}
+
+void PollutionManager::spreadColumns(int startY, int endY)
+{
+	float* pollution = m_sim->getTiles()->getPollutionData();
+	const int width = m_width;
+
+	// the fading is folded into the spreading weights
+	const float keep = (1.0f - 2.0f * POLLUTION_DIFFUSION) * POLLUTION_DECAY;
+	const float take = POLLUTION_DIFFUSION * POLLUTION_DECAY;
+	const float emit = 1.0f - POLLUTION_DECAY;
+
+	for (int y = startY; y < endY; ++y)
+	{
+		const float* up = y > 0 ? &m_spread[(y - 1) * width] : &m_emptyRow[0];
+		const float* down = y < m_height - 1 ? &m_spread[(y + 1) * width]
+			: &m_emptyRow[0];
+		const float* centre = &m_spread[y * width];
+		const float* emission = &m_emission[y * width];
+		float* out = pollution + y * width;
+
+		int x = 0;
+#ifdef POLLUTION_SSE
+		const __m128 keep4 = _mm_set1_ps(keep);
+		const __m128 take4 = _mm_set1_ps(take);
+		const __m128 emit4 = _mm_set1_ps(emit);
+		const __m128 min4 = _mm_set1_ps(POLLUTION_MIN);
+		for (; x + 4 <= width; x += 4)
+		{
+			__m128 sides = _mm_add_ps(_mm_loadu_ps(up + x),
+				_mm_loadu_ps(down + x));
+			__m128 value = _mm_mul_ps(_mm_loadu_ps(centre + x), keep4);
+			value = _mm_add_ps(value, _mm_mul_ps(sides, take4));
+			value = _mm_add_ps(value,
+				_mm_mul_ps(_mm_loadu_ps(emission + x), emit4));
+			// zero anything under the minimum
+			value = _mm_and_ps(value, _mm_cmpge_ps(value, min4));
+			_mm_storeu_ps(out + x, value);
+		}
+#endif
+		for (; x < width; ++x)
+		{
+			float value = centre[x] * keep + (up[x] + down[x]) * take
+				+ emission[x] * emit;
+			out[x] = value >= POLLUTION_MIN ? value : 0.0f;
+		}
+	}
+}
\ No newline at end of file
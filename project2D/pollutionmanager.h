@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+
+// how many sim ticks go by between each time pollution spreads and fades
+#define POLLUTION_TICKS_PER_STEP 6
+// how many tiles from an emitter its pollution is put down
+#define POLLUTION_SPREAD_RANGE 7
+// how much of a tile's pollution is left after each step, the rest fades
+#define POLLUTION_DECAY 0.98f
+// how much of a tile's pollution drifts to each neighbour every step
+#define POLLUTION_DIFFUSION 0.1f
+// pollution below this is cleared to nothing, so it doesn't hang around as
+//   tiny numbers which are slow to do maths on
+#define POLLUTION_MIN 0.01f
+// how many rows of tiles each job spreads pollution over at once
+#define POLLUTION_ROWS_PER_JOB 32
+
+// Forward declares
+class Simulation;
+
+// keeps the pollution on every tile moving
+// emitters (factories) stamp how polluted they make the tiles around them
+//   into an emission map when they're added and take it away when they're
+//   removed, and every step the pollution on the tiles spreads out to their
+//   neighbours, fades a little, and creeps towards the emission map
+// the pollution itself is stored in the TileGrid
+class PollutionManager
+{
+public:
+	//------------------------------------------------------------------------
+	// (explicit because we don't want any implicit conversion)
+	//
+	// Param:
+	//			sim:  pointer to our Simulation so we can access everything
+	//------------------------------------------------------------------------
+	explicit PollutionManager(Simulation* sim);
+
+	// we don't expect PollutionManager to be copied/moved
+	PollutionManager(const PollutionManager& pm) = default;
+	PollutionManager(PollutionManager&& pm) = default;
+	PollutionManager& operator=(PollutionManager& pm) = default;
+	PollutionManager& operator=(PollutionManager&& pm) = default;
+
+	//------------------------------------------------------------------------
+	// Throws away every emitter and sizes the emission map to fit the world
+	// Should be called whenever the TileGrid is resized
+	//
+	// Param:
+	//			width:  how many tiles wide the world is
+	//			height: how many tiles tall the world is
+	//------------------------------------------------------------------------
+	void resize(int width, int height);
+
+	//------------------------------------------------------------------------
+	// Starts pollution coming from a tile
+	//
+	// Param:
+	//			x:      x index of the tile
+	//			y:      y index of the tile
+	//			amount: how polluted the emitter's own tile ends up
+	//------------------------------------------------------------------------
+	void addEmitter(int x, int y, float amount);
+	//------------------------------------------------------------------------
+	// Stops pollution coming from a tile, undoing addEmitter
+	// Pollution already on the tiles is left to fade away
+	//
+	// Param:
+	//			x:      x index of the tile
+	//			y:      y index of the tile
+	//			amount: the same amount given to addEmitter
+	//------------------------------------------------------------------------
+	void removeEmitter(int x, int y, float amount);
+
+	//------------------------------------------------------------------------
+	// Spreads and fades the pollution on every tile once
+	// Called by the Simulation every POLLUTION_TICKS_PER_STEP ticks
+	//------------------------------------------------------------------------
+	void step();
+private:
+	Simulation* m_sim;
+
+	int m_width, m_height;
+
+	// how polluted each tile would settle at with only the emitters to go
+	//   on, before spreading
+	std::vector<float> m_emission;
+	// the pollution after spreading along the rows, before it's spread
+	//   along the columns
+	std::vector<float> m_spread;
+	// a row of nothing, used as the rows off the edges of the map
+	std::vector<float> m_emptyRow;
+
+	// what an emitter of 1 puts on the tiles around it, worked out once
+	// (POLLUTION_SPREAD_RANGE * 2 + 1) tiles along each side
+	std::vector<float> m_kernel;
+
+	// adds the kernel times amount onto the emission map around a tile
+	void stampEmitter(int x, int y, float amount);
+	// spreads each row of pollution into m_spread, for rows startY up to
+	//   (not including) endY
+	void spreadRows(int startY, int endY);
+	// spreads m_spread along the columns, fades it and pulls it towards the
+	//   emission map, writing it back onto the tiles
+	void spreadColumns(int startY, int endY);
+};
\ No newline at end of file
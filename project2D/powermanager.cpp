@@ -0,0 +1,640 @@
+#include "powermanager.h"
+
+#include <algorithm>
+
+#include "Profiler.h"
+#include "JobSystem.h"
+
+#include "darray.h"
+#include "building.h"
+#include "tilegrid.h"
+#include "simulation.h"
+#include "buildingmanager.h"
+
+PowerManager::PowerManager(Simulation* sim)
+	: m_sim(sim)
+{
+	m_networkCount = 0;
+	m_visitMark = 0;
+	m_maxSpread = 0;
+	m_maxSearch = 0;
+}
+
+void PowerManager::addBuilding(Building* build)
+{
+	if (build->getPowerNode() >= 0)
+		return;
+
+	makeNode(build);
+
+	// it's the newest node, so it looks at everything already in the grid
+	std::vector<Building*> found;
+	findLinks(build, found);
+	for (auto other : found)
+	{
+		getNode(build).links.push_back(other);
+		getNode(other).links.push_back(build);
+	}
+
+	// it joins a network and gets its power on the next update
+	m_added.push_back(build);
+}
+
+void PowerManager::addBuildings(
+	const std::vector<std::vector<Building*>>& groups)
+{
+	PROFILE_ZONE("PowerManager::addBuildings");
+
+	// every building gets its node before any links are looked for, so
+	//   they can find each other
+	std::vector<int> groupStarts;
+	groupStarts.reserve(groups.size() + 1);
+	for (auto& group : groups)
+	{
+		groupStarts.push_back((int)m_nodes.size());
+		for (auto build : group)
+		{
+			if (build->getPowerNode() >= 0)
+				continue;
+
+			makeNode(build);
+			// they join networks and get their power on the next update
+			m_added.push_back(build);
+		}
+	}
+	groupStarts.push_back((int)m_nodes.size());
+
+	linkNodes(groupStarts);
+}
+
+void PowerManager::rebuild()
+{
+	PROFILE_ZONE("PowerManager::rebuild");
+
+	clearBuildings();
+
+	BuildingList* buildings = m_sim->getBuildingManager()->getBuildings();
+	const int count = buildings->getCount();
+
+	// every building gets its node, then they're linked a block at a time
+	m_nodes.reserve(count);
+	std::vector<int> groupStarts;
+	for (int i = 0; i < count; ++i)
+	{
+		if (i % POWER_LINKS_PER_JOB == 0)
+			groupStarts.push_back(i);
+		makeNode((*buildings)[i]);
+	}
+	groupStarts.push_back(count);
+
+	linkNodes(groupStarts);
+
+	// then every network and all the power is worked out at once
+	m_dirty.reserve(count);
+	for (int i = 0; i < count; ++i)
+		m_dirty.push_back((*buildings)[i]);
+
+	std::vector<Building*> lostPower, gainedPower;
+	recalculateDirty(lostPower, gainedPower);
+	applyPower(lostPower, gainedPower);
+}
+
+void PowerManager::removeBuilding(Building* build)
+{
+	const int index = build->getPowerNode();
+	if (index < 0)
+		return;
+
+	PowerNode& node = m_nodes[index];
+
+	// take our power away from the tiles
+	if (build->hasPower())
+	{
+		spreadPower(build, false);
+		build->setPower(false);
+	}
+
+	if (node.network < 0)
+	{
+		// it never got as far as joining a network
+		m_added.erase(std::remove(m_added.begin(), m_added.end(), build),
+			m_added.end());
+	}
+	else if (--m_networkSizes[node.network] == 0)
+	{
+		// a building on its own takes its network with it
+		// otherwise the neighbours will sort out what's left of it
+		m_freeNetworks.push_back(node.network);
+		m_networkCount--;
+	}
+
+	// unlink from everything and let the neighbours recalculate
+	for (auto other : node.links)
+	{
+		std::vector<Building*>& otherLinks = getNode(other).links;
+		otherLinks.erase(std::remove(otherLinks.begin(), otherLinks.end(),
+			build), otherLinks.end());
+		m_dirty.push_back(other);
+	}
+
+	m_dirty.erase(std::remove(m_dirty.begin(), m_dirty.end(), build),
+		m_dirty.end());
+
+	// fill the gap with the last node so they stay packed
+	if (index != (int)m_nodes.size() - 1)
+	{
+		node = std::move(m_nodes.back());
+		node.building->setPowerNode(index);
+	}
+	m_nodes.pop_back();
+	build->setPowerNode(-1);
+}
+
+void PowerManager::clearBuildings()
+{
+	for (auto& node : m_nodes)
+	{
+		node.building->setPower(false);
+		node.building->setPowerNode(-1);
+	}
+	// nothing is left to power the tiles, so take it all away at once
+	m_sim->getTiles()->clearPower();
+
+	m_nodes.clear();
+	m_dirty.clear();
+	m_added.clear();
+	m_networkSizes.clear();
+	m_freeNetworks.clear();
+	m_networkCount = 0;
+	m_maxSpread = 0;
+	m_maxSearch = 0;
+}
+
+void PowerManager::updatePower()
+{
+	PROFILE_ZONE("PowerManager::updatePower");
+
+	// nothing changed, so nothing to do
+	if (m_dirty.empty() && m_added.empty())
+		return;
+
+	// the tiles are all given their new power in one go at the end
+	std::vector<Building*> lostPower, gainedPower;
+
+	// removing buildings can split networks up and cut off their power,
+	//   so those networks are worked out again
+	if (!m_dirty.empty())
+		recalculateDirty(lostPower, gainedPower);
+
+	// but adding them only ever joins networks and spreads power further
+	joinAdded(gainedPower);
+
+	applyPower(lostPower, gainedPower);
+}
+
+PowerManager::PowerNode& PowerManager::getNode(const Building* build)
+{
+	return m_nodes[build->getPowerNode()];
+}
+
+void PowerManager::makeNode(Building* build)
+{
+	// keep track of how far we have to look for links
+	m_maxSpread = std::max(m_maxSpread, build->getPowerSpread());
+	m_maxSearch = std::max(m_maxSearch, build->getPowerSearch());
+
+	build->setPowerNode((int)m_nodes.size());
+	m_nodes.emplace_back();
+	PowerNode& node = m_nodes.back();
+	node.building = build;
+	node.network = -1;
+	node.visited = 0;
+}
+
+void PowerManager::findLinks(Building* build,
+	std::vector<Building*>& found) const
+{
+	// anything that could link to us covers a tile within our spread plus
+	//   the furthest anything searches, or our search plus the furthest
+	//   anything spreads
+	int range = std::max(build->getPowerSpread() + m_maxSearch,
+		build->getPowerSearch() + m_maxSpread);
+
+	TileGrid* tiles = m_sim->getTiles();
+	int minX, minY, maxX, maxY;
+	build->getPowerBounds(range, &minX, &minY, &maxX, &maxY);
+	minX = std::max(minX, 0);
+	minY = std::max(minY, 0);
+	maxX = std::min(maxX, tiles->getWidth() - 1);
+	maxY = std::min(maxY, tiles->getHeight() - 1);
+
+	// only earlier nodes, so two buildings linking at once only find each
+	//   other the once
+	const int index = build->getPowerNode();
+
+	for (int y = minY; y <= maxY; ++y)
+	{
+		for (int x = minX; x <= maxX; ++x)
+		{
+			Building* other = tiles->getBuilding(x, y);
+			if (!other || other->getPowerNode() < 0 ||
+				other->getPowerNode() >= index)
+				continue;
+
+			// buildings can cover more than one tile, so each one is only
+			//   checked from the first of its tiles we come to
+			int posX, posY, sizeX, sizeY;
+			other->getPosition(&posX, &posY);
+			other->getSize(&sizeX, &sizeY);
+			if (x != std::max(posX - sizeX + 1, minX) ||
+				y != std::max(posY - sizeY + 1, minY))
+				continue;
+
+			if (!givesPowerTo(build, other) && !givesPowerTo(other, build))
+				continue;
+
+			found.push_back(other);
+		}
+	}
+}
+
+void PowerManager::linkNodes(const std::vector<int>& groupStarts)
+{
+	PROFILE_ZONE("PowerManager::linkNodes");
+
+	const int groupCount = (int)groupStarts.size() - 1;
+	if (groupCount <= 0)
+		return;
+
+	// each group keeps the pairs it finds to itself
+	std::vector<std::vector<int>> pairs(groupCount);
+	aie::JobSystem::getInstance()->parallelFor(groupCount, 1,
+		[&](int start, int end)
+	{
+		std::vector<Building*> found;
+		for (int group = start; group < end; ++group)
+		{
+			for (int i = groupStarts[group]; i < groupStarts[group + 1]; ++i)
+			{
+				found.clear();
+				findLinks(m_nodes[i].building, found);
+				for (auto other : found)
+				{
+					pairs[group].push_back(i);
+					pairs[group].push_back(other->getPowerNode());
+				}
+			}
+		}
+	});
+
+	// the new nodes are given all the room their links need at once
+	const int first = groupStarts.front();
+	std::vector<int> linkCounts(groupStarts.back() - first, 0);
+	for (auto& groupPairs : pairs)
+	{
+		for (auto index : groupPairs)
+		{
+			if (index >= first)
+				linkCounts[index - first]++;
+		}
+	}
+	for (size_t i = 0; i < linkCounts.size(); ++i)
+		m_nodes[first + i].links.reserve(linkCounts[i]);
+
+	for (auto& groupPairs : pairs)
+	{
+		for (size_t i = 0; i < groupPairs.size(); i += 2)
+		{
+			PowerNode& node = m_nodes[groupPairs[i]];
+			PowerNode& other = m_nodes[groupPairs[i + 1]];
+			node.links.push_back(other.building);
+			other.links.push_back(node.building);
+		}
+	}
+}
+
+int PowerManager::newNetwork()
+{
+	m_networkCount++;
+
+	if (!m_freeNetworks.empty())
+	{
+		int network = m_freeNetworks.back();
+		m_freeNetworks.pop_back();
+		return network;
+	}
+
+	m_networkSizes.push_back(0);
+	return (int)m_networkSizes.size() - 1;
+}
+
+void PowerManager::mergeNetwork(Building* other, const int network)
+{
+	const int oldNetwork = getNode(other).network;
+
+	// everything in a network is linked together, so searching from any of
+	//   it finds the rest
+	std::vector<Building*> queue;
+	queue.push_back(other);
+	getNode(other).network = network;
+	for (size_t i = 0; i < queue.size(); ++i)
+	{
+		for (auto next : getNode(queue[i]).links)
+		{
+			PowerNode& nextNode = getNode(next);
+			if (nextNode.network != oldNetwork)
+				continue;
+			nextNode.network = network;
+			queue.push_back(next);
+		}
+	}
+
+	m_networkSizes[network] += m_networkSizes[oldNetwork];
+	m_networkSizes[oldNetwork] = 0;
+	m_freeNetworks.push_back(oldNetwork);
+	m_networkCount--;
+}
+
+void PowerManager::recalculateDirty(std::vector<Building*>& lost,
+	std::vector<Building*>& gained)
+{
+	// grab every building in the networks that were touched
+	m_visitMark++;
+	std::vector<Building*> affected;
+	for (auto b : m_dirty)
+	{
+		PowerNode& start = getNode(b);
+		if (start.visited == m_visitMark)
+			continue;
+		start.visited = m_visitMark;
+		affected.push_back(b);
+
+		// affected doubles as the queue for the search
+		for (size_t i = affected.size() - 1; i < affected.size(); ++i)
+		{
+			for (auto other : getNode(affected[i]).links)
+			{
+				PowerNode& otherNode = getNode(other);
+				if (otherNode.visited == m_visitMark)
+					continue;
+				otherNode.visited = m_visitMark;
+				affected.push_back(other);
+			}
+		}
+	}
+	m_dirty.clear();
+
+	// forget the old networks and their power
+	// every building that was in those networks is in here, so they can
+	//   be given out again straight away
+	for (auto b : affected)
+	{
+		PowerNode& node = getNode(b);
+		if (node.network >= 0 && m_networkSizes[node.network] > 0)
+		{
+			m_networkSizes[node.network] = 0;
+			m_freeNetworks.push_back(node.network);
+			m_networkCount--;
+		}
+		node.network = -1;
+
+		if (b->hasPower())
+		{
+			lost.push_back(b);
+			b->setPower(false);
+		}
+	}
+
+	// split what's left into networks again
+	std::vector<Building*> queue;
+	for (auto b : affected)
+	{
+		if (getNode(b).network >= 0)
+			continue;
+
+		int network = newNetwork();
+
+		queue.clear();
+		queue.push_back(b);
+		getNode(b).network = network;
+		for (size_t i = 0; i < queue.size(); ++i)
+		{
+			for (auto other : getNode(queue[i]).links)
+			{
+				PowerNode& otherNode = getNode(other);
+				if (otherNode.network >= 0)
+					continue;
+				otherNode.network = network;
+				queue.push_back(other);
+			}
+		}
+		m_networkSizes[network] = (int)queue.size();
+	}
+
+	// then flow power outwards from anything that makes it
+	int start = (int)gained.size();
+	for (auto b : affected)
+	{
+		if (!b->producesPower())
+			continue;
+		b->setPower(true);
+		gained.push_back(b);
+	}
+	flowPower(gained, start);
+}
+
+void PowerManager::joinAdded(std::vector<Building*>& gained)
+{
+	for (auto b : m_added)
+	{
+		PowerNode& node = getNode(b);
+		// already sorted out along with a removed neighbour
+		if (node.network >= 0)
+			continue;
+
+		// join the biggest network it touches, so the fewest buildings have
+		//   to move, then bring the rest of them into it
+		int network = -1;
+		for (auto other : node.links)
+		{
+			int otherNetwork = getNode(other).network;
+			if (otherNetwork >= 0 && (network < 0
+				|| m_networkSizes[otherNetwork] > m_networkSizes[network]))
+				network = otherNetwork;
+		}
+		if (network < 0)
+			network = newNetwork();
+
+		node.network = network;
+		m_networkSizes[network]++;
+
+		for (auto other : node.links)
+		{
+			int otherNetwork = getNode(other).network;
+			if (otherNetwork >= 0 && otherNetwork != network)
+				mergeNetwork(other, network);
+		}
+
+		// it might have been given power by something added before it
+		if (b->hasPower())
+			continue;
+
+		// otherwise it only has power if it makes it or a neighbour passes
+		//   it on, and then it passes it on to anything it reaches
+		bool powered = b->producesPower();
+		for (size_t i = 0; !powered && i < node.links.size(); ++i)
+		{
+			Building* other = node.links[i];
+			powered = other->hasPower() && givesPowerTo(other, b);
+		}
+		if (!powered)
+			continue;
+
+		b->setPower(true);
+		gained.push_back(b);
+		flowPower(gained, (int)gained.size() - 1);
+	}
+	m_added.clear();
+}
+
+void PowerManager::flowPower(std::vector<Building*>& gained,
+	const int start)
+{
+	// gained doubles as the queue
+	for (size_t i = start; i < gained.size(); ++i)
+	{
+		Building* from = gained[i];
+		for (auto other : getNode(from).links)
+		{
+			if (other->hasPower() || !givesPowerTo(from, other))
+				continue;
+			other->setPower(true);
+			gained.push_back(other);
+		}
+	}
+}
+
+bool PowerManager::givesPowerTo(Building* from, Building* to) const
+{
+	// the tiles 'from' spreads power to
+	int fromMinX, fromMinY, fromMaxX, fromMaxY;
+	from->getPowerBounds(from->getPowerSpread(),
+		&fromMinX, &fromMinY, &fromMaxX, &fromMaxY);
+	// and the tiles 'to' looks for power on
+	int toMinX, toMinY, toMaxX, toMaxY;
+	to->getPowerBounds(to->getPowerSearch(),
+		&toMinX, &toMinY, &toMaxX, &toMaxY);
+
+	// they need to share at least one tile inside the world
+	int minX = std::max(std::max(fromMinX, toMinX), 0);
+	int minY = std::max(std::max(fromMinY, toMinY), 0);
+	TileGrid* tiles = m_sim->getTiles();
+	int maxX = std::min(std::min(fromMaxX, toMaxX), tiles->getWidth() - 1);
+	int maxY = std::min(std::min(fromMaxY, toMaxY), tiles->getHeight() - 1);
+
+	return minX <= maxX && minY <= maxY;
+}
+
+void PowerManager::spreadPower(Building* build, bool give) const
+{
+	spreadPower(build, give, 0, m_sim->getTiles()->getHeight());
+}
+
+void PowerManager::spreadPower(Building* build, const bool give,
+	const int startY, const int endY) const
+{
+	TileGrid* tiles = m_sim->getTiles();
+
+	int minX, minY, maxX, maxY;
+	build->getPowerBounds(build->getPowerSpread(), &minX, &minY, &maxX, &maxY);
+	minY = std::max(minY, startY);
+	maxY = std::min(maxY, endY - 1);
+
+	for (int y = minY; y <= maxY; ++y)
+	{
+		for (int x = minX; x <= maxX; ++x)
+		{
+			if (!tiles->isInBounds(x, y))
+				continue;
+
+			if (give)
+				tiles->addPower(x, y);
+			else
+				tiles->removePower(x, y);
+		}
+	}
+}
+
+void PowerManager::applyPower(const std::vector<Building*>& lost,
+	const std::vector<Building*>& gained) const
+{
+	if (lost.empty() && gained.empty())
+		return;
+
+	struct PowerChange
+	{
+		Building*	build;
+		bool		give;
+	};
+
+	const int height = m_sim->getTiles()->getHeight();
+	const int bandCount = (height + POWER_ROWS_PER_JOB - 1)
+		/ POWER_ROWS_PER_JOB;
+
+	// the bands of rows a building's power reaches
+	auto getBands = [&](Building* b, int* first, int* last)
+	{
+		int minX, minY, maxX, maxY;
+		b->getPowerBounds(b->getPowerSpread(), &minX, &minY, &maxX, &maxY);
+		*first = std::max(minY, 0) / POWER_ROWS_PER_JOB;
+		*last = std::min(maxY, height - 1) / POWER_ROWS_PER_JOB;
+	};
+
+	// sort the changes into every band they reach, so each job only looks
+	//   at the buildings touching its own rows
+	// lost go before gained in every band, the same as doing them one by one
+	std::vector<int> offsets(bandCount + 1, 0);
+	int first, last;
+	for (auto b : lost)
+	{
+		getBands(b, &first, &last);
+		for (int band = first; band <= last; ++band)
+			offsets[band + 1]++;
+	}
+	for (auto b : gained)
+	{
+		getBands(b, &first, &last);
+		for (int band = first; band <= last; ++band)
+			offsets[band + 1]++;
+	}
+	for (int band = 1; band <= bandCount; ++band)
+		offsets[band] += offsets[band - 1];
+
+	std::vector<PowerChange> changes(offsets[bandCount]);
+	std::vector<int> next(offsets.begin(), offsets.end() - 1);
+	for (auto b : lost)
+	{
+		getBands(b, &first, &last);
+		for (int band = first; band <= last; ++band)
+			changes[next[band]++] = { b, false };
+	}
+	for (auto b : gained)
+	{
+		getBands(b, &first, &last);
+		for (int band = first; band <= last; ++band)
+			changes[next[band]++] = { b, true };
+	}
+
+	// each job only touches its own rows, so none of them share a tile
+	aie::JobSystem::getInstance()->parallelFor(bandCount, 1,
+		[&](int start, int end)
+	{
+		for (int band = start; band < end; ++band)
+		{
+			int startY = band * POWER_ROWS_PER_JOB;
+			int endY = std::min(startY + POWER_ROWS_PER_JOB, height);
+			for (int i = offsets[band]; i < offsets[band + 1]; ++i)
+				spreadPower(changes[i].build, changes[i].give, startY, endY);
+		}
+	});
+}
\ No newline at end of file
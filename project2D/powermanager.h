@@ -0,0 +1,166 @@
+#pragma once
+
+#include <vector>
+
+// how many rows of tiles each job updates the power of at once
+#define POWER_ROWS_PER_JOB 16
+// how many buildings each job finds the links of when the whole grid is
+//   built again
+#define POWER_LINKS_PER_JOB 256
+
+// Forward declares
+class Building;
+class Simulation;
+
+class PowerManager
+{
+public:
+	//------------------------------------------------------------------------
+	// (explicit because we don't want any implicit conversion)
+	//
+	// Param:
+	//			sim:  pointer to our Simulation so we can access everything
+	//------------------------------------------------------------------------
+	explicit PowerManager(Simulation* sim);
+
+	// we don't expect PowerManager to be copied/moved
+	PowerManager(const PowerManager& pm) = default;
+	PowerManager(PowerManager&& pm) = default;
+	PowerManager& operator=(PowerManager& pm) = default;
+	PowerManager& operator=(PowerManager&& pm) = default;
+
+	//------------------------------------------------------------------------
+	// Links a building into the power grid
+	// Should be called whenever a building is added to the world, after the
+	// tiles know which building is on them
+	//
+	// Param:
+	//			build: the building being added
+	//------------------------------------------------------------------------
+	void addBuilding(Building* build);
+	//------------------------------------------------------------------------
+	// Links lots of buildings into the power grid at once, the same as
+	//   calling addBuilding on each of them in order
+	// Each group's links are found as a job, so groups of buildings that
+	//   are close together keep each job to its own part of the map
+	//
+	// Param:
+	//			groups: the buildings being added, already on their tiles
+	//------------------------------------------------------------------------
+	void addBuildings(const std::vector<std::vector<Building*>>& groups);
+	//------------------------------------------------------------------------
+	// Forgets the grid and builds it again from every building in the
+	//   world, linking them all in one go and working out every network and
+	//   the power of every tile at once
+	// Used after adding lots of buildings at once, like when loading
+	//------------------------------------------------------------------------
+	void rebuild();
+	//------------------------------------------------------------------------
+	// Unlinks a building from the power grid and takes away any power it was
+	// giving to tiles
+	// Should be called whenever a building is removed from the world
+	//
+	// Param:
+	//			build: the building being removed
+	//------------------------------------------------------------------------
+	void removeBuilding(Building* build);
+	//------------------------------------------------------------------------
+	// Forgets about every building in the grid
+	//------------------------------------------------------------------------
+	void clearBuildings();
+
+	//------------------------------------------------------------------------
+	// Recalculates power for any networks which changed since the last call
+	// Does nothing if no buildings were added or removed
+	// Added buildings only pass power on from where they are, and join up
+	//   the networks they touch, so only removing buildings means working
+	//   out a whole network again
+	//------------------------------------------------------------------------
+	void updatePower();
+
+	//------------------------------------------------------------------------
+	// Gets how many separate power networks are in the world
+	// A network is a group of buildings close enough to pass power between
+	// each other, whether or not it has a power plant
+	//
+	// Return:
+	//			the number of networks
+	//------------------------------------------------------------------------
+	int getNetworkCount() const { return m_networkCount; }
+private:
+	// info the grid keeps about each building
+	struct PowerNode
+	{
+		// the building this is for
+		Building* building;
+		// buildings close enough to pass power to/from this one
+		std::vector<Building*> links;
+		// which network this building belongs to, -1 if not assigned yet
+		int network;
+		// used to avoid visiting the same node twice in a search
+		unsigned int visited;
+	};
+
+	Simulation* m_sim;
+
+	// every building's node, found with Building::getPowerNode
+	// kept packed, so removing a node moves the last one into its place
+	std::vector<PowerNode> m_nodes;
+	// buildings whose networks need to be recalculated
+	std::vector<Building*> m_dirty;
+	// buildings added since the last update, which haven't joined a
+	//   network yet
+	std::vector<Building*> m_added;
+
+	// how many buildings are in each network, 0 for networks not in use
+	std::vector<int> m_networkSizes;
+	// networks not in use, to be given out again
+	std::vector<int> m_freeNetworks;
+	int m_networkCount;
+	unsigned int m_visitMark;
+
+	// the furthest any building spreads power, and searches for it
+	// used to know how far to look for links when adding a building
+	int m_maxSpread;
+	int m_maxSearch;
+
+	// gets the node for a building that's in the grid
+	PowerNode& getNode(const Building* build);
+	// gives a building a node at the end of the grid, without linking it
+	void makeNode(Building* build);
+	// finds every building with an earlier node than build's that it can
+	//   pass power to or get it from
+	// only reads the grid, so it's safe to run on any thread
+	void findLinks(Building* build, std::vector<Building*>& found) const;
+	// links the nodes from each group start up to the next one, finding
+	//   each group's links as a job and then linking them up in order, so
+	//   it comes out the same whichever thread found them
+	void linkNodes(const std::vector<int>& groupStarts);
+	// makes a new empty network
+	int newNetwork();
+	// moves every building in other's network into network
+	void mergeNetwork(Building* other, int network);
+	// works out the networks and power of every building connected to the
+	//   dirty buildings from scratch
+	void recalculateDirty(std::vector<Building*>& lost,
+		std::vector<Building*>& gained);
+	// puts the added buildings into networks, merging the ones they join,
+	//   and passes power on from them
+	void joinAdded(std::vector<Building*>& gained);
+	// gives power to everything it can flow to from gained[start] onwards,
+	//   adding them to the end of gained
+	void flowPower(std::vector<Building*>& gained, int start);
+
+	// whether or not a powered 'from' would give power to 'to'
+	bool givesPowerTo(Building* from, Building* to) const;
+	// adds or removes a building's power from the tiles around it
+	void spreadPower(Building* build, bool give) const;
+	// the same, but only for the tiles in rows startY up to (not including)
+	//   endY, so different rows can be done at the same time
+	void spreadPower(Building* build, bool give, int startY, int endY) const;
+	// takes power away from the tiles around lost and gives it to the tiles
+	//   around gained, with the rows split up between jobs that each only
+	//   go over the buildings reaching their rows
+	void applyPower(const std::vector<Building*>& lost,
+		const std::vector<Building*>& gained) const;
+};
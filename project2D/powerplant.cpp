@@ -1,11 +1,11 @@
 #include "powerplant.h"
 
-#include "game.h"
 #include "random.h"
+#include "simulation.h"
 #include "imagemanager.h"
 
-PowerPlant::PowerPlant(Game* game, int x, int y)
-	: Building(game, x, y)
+PowerPlant::PowerPlant(Simulation* sim, int x, int y)
+	: Building(sim, x, y)
 {
 	m_type = BUILDINGTYPE_POWERPLANT;
 	m_sizeX = 4;
@@ -15,7 +15,7 @@ PowerPlant::PowerPlant(Game* game, int x, int y)
 
 	m_price = 1000;
 
-	m_texture = game->getImageManager()->getTexture("buildings/powerplant");
+	m_sprite = sim->getImageManager()->getSprite(SPRITE_POWERPLANT);
 
 	// eyes and mouth stuff
 	m_drawFace = false;
@@ -23,8 +23,8 @@ PowerPlant::PowerPlant(Game* game, int x, int y)
 	m_mouthOpen = false;
 	m_blinkTimer = 0;
 
-	m_openMouth = game->getImageManager()->getTexture("mouth_open");
-	m_closedMouth = game->getImageManager()->getTexture("mouth_closed");
+	m_openMouth = sim->getImageManager()->getSprite(SPRITE_MOUTH_OPEN);
+	m_closedMouth = sim->getImageManager()->getSprite(SPRITE_MOUTH_CLOSED);
 }
 
 void PowerPlant::update(float delta)
@@ -42,12 +42,13 @@ void PowerPlant::update(float delta)
 		if (m_blinking)
 			m_blinkTimer = blinkLength;
 		else
-			m_blinkTimer = randBetween(1.0f, 10.0f);
+			m_blinkTimer = m_sim->getRandom(RANDOMSTREAM_BUILDINGS)
+				.randBetween(1.0f, 10.0f);
 	}
 
 	// open the mouth if the mouse is close to us
 
-	Vector2 mousePos = m_game->getMouseWorldPosition();
+	Vector2 mousePos = m_sim->getMouseWorldPosition();
 	// add 256 to our Y so it's not the distance to the bottom of building
 	Vector2 thisPos = m_worldPos + Vector2(0, 256);
 	float dist = mousePos.distanceToSquared((thisPos));
@@ -69,8 +70,8 @@ void PowerPlant::draw(aie::Renderer2D* renderer)
 	// move the sprite up slightly so it lines up with the ground
 	const float yOffset = -4;
 
-	renderer->drawSprite(m_texture, m_worldPos.getX(),
-		m_worldPos.getY() - yOffset + m_altitude, 0, 0, 0, 0, xOrigin, yOrigin);
+	m_sprite->draw(renderer, m_worldPos.getX(),
+		m_worldPos.getY() - yOffset + m_altitude, 0, 0, xOrigin, yOrigin);
 
 	if (!m_drawFace)
 		return;
@@ -91,9 +92,9 @@ void PowerPlant::draw(aie::Renderer2D* renderer)
 	// draw mouth
 	const Vector2 mouthOffset(161.0f, 120.0f);
 
-	aie::Texture* mtex = m_mouthOpen ? m_openMouth : m_closedMouth;
+	Sprite* mouth = m_mouthOpen ? m_openMouth : m_closedMouth;
 	renderer->setRenderColour(1, 1, 1);
-	renderer->drawSprite(mtex, m_worldPos.getX() + mouthOffset.getX(),
+	mouth->draw(renderer, m_worldPos.getX() + mouthOffset.getX(),
 		m_worldPos.getY() + mouthOffset.getY() + m_altitude);
 }
 
@@ -5,7 +5,7 @@
 class PowerPlant : public Building
 {
 public:
-	PowerPlant(Game* game, int x, int y);
+	PowerPlant(Simulation* sim, int x, int y);
 
 	void update(float delta) override;
 	void draw(aie::Renderer2D* renderer) override;
@@ -13,8 +13,8 @@ public:
 	void created() override;
 private:
 	// textures for the face of the building
-	aie::Texture* m_openMouth;
-	aie::Texture* m_closedMouth;
+	Sprite* m_openMouth;
+	Sprite* m_closedMouth;
 
 	// whether or not the face should be drawn
 	bool m_drawFace;
@@ -1,10 +1,10 @@
 #include "powerpole.h"
 
-#include "game.h"
+#include "simulation.h"
 #include "imagemanager.h"
 
-PowerPole::PowerPole(Game* game, int x, int y)
-	: Building(game, x, y)
+PowerPole::PowerPole(Simulation* sim, int x, int y)
+	: Building(sim, x, y)
 {
 	m_type = BUILDINGTYPE_POWERPOLE;
 	m_buildStyle = BUILDSTYLE_LINE;
@@ -15,7 +15,7 @@ PowerPole::PowerPole(Game* game, int x, int y)
 
 	m_price = 5;
 
-	m_texture = m_game->getImageManager()->getTexture("buildings/powerpole");
+	m_sprite = m_sim->getImageManager()->getSprite(SPRITE_POWERPOLE);
 }
 
 void PowerPole::draw(aie::Renderer2D* renderer)
@@ -27,6 +27,6 @@ void PowerPole::draw(aie::Renderer2D* renderer)
 	// (where it would be touching the ground)
 	const float xOrigin = 0.5f;
 	const float yOrigin = 0.0f;
-	renderer->drawSprite(m_texture, m_worldPos.getX(),
-		m_worldPos.getY() + m_altitude, 0, 0, 0, 0, xOrigin, yOrigin);
+	m_sprite->draw(renderer, m_worldPos.getX(),
+		m_worldPos.getY() + m_altitude, 0, 0, xOrigin, yOrigin);
 }
\ No newline at end of file
@@ -5,7 +5,7 @@
 class PowerPole : public Building
 {
 public:
-	PowerPole(Game* game, int x, int y);
+	PowerPole(Simulation* sim, int x, int y);
 
 	void draw(aie::Renderer2D* renderer) override;
 };
\ No newline at end of file
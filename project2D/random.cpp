@@ -1,12 +1,78 @@
-#include <cmath>
+#include "random.h"
 
-int randBetween(int min, int max)
+// splitmix64, used to spread a seed out over the whole state so similar
+//   seeds still give completely different numbers
+static unsigned long long splitMix(unsigned long long& x)
 {
-	return min + (rand() % max - min);
+	unsigned long long z = (x += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
 }
 
-float randBetween(float min, float max)
+static inline unsigned int rotateLeft(const unsigned int x, const int k)
 {
-	float percentage = (rand() % 10000) / 10000.0f;
-	return min + ((max - min) * percentage);
+	return (x << k) | (x >> (32 - k));
+}
+
+// turns the top 24 bits of a random number into a float in [0, 1)
+static inline float toUnitFloat(const unsigned int x)
+{
+	return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+Random::Random(const unsigned int seed, const unsigned int stream)
+{
+	this->seed(seed, stream);
+}
+
+void Random::seed(const unsigned int seed, const unsigned int stream)
+{
+	// the stream goes in the top half so every seed/stream pair is unique
+	unsigned long long x = ((unsigned long long)stream << 32) | seed;
+	unsigned long long a = splitMix(x);
+	unsigned long long b = splitMix(x);
+	m_state[0] = (unsigned int)a;
+	m_state[1] = (unsigned int)(a >> 32);
+	m_state[2] = (unsigned int)b;
+	m_state[3] = (unsigned int)(b >> 32);
+}
+
+unsigned int Random::next()
+{
+	const unsigned int result = rotateLeft(m_state[1] * 5, 7) * 9;
+	const unsigned int t = m_state[1] << 9;
+
+	m_state[2] ^= m_state[0];
+	m_state[3] ^= m_state[1];
+	m_state[1] ^= m_state[2];
+	m_state[0] ^= m_state[3];
+
+	m_state[2] ^= t;
+	m_state[3] = rotateLeft(m_state[3], 11);
+
+	return result;
+}
+
+int Random::randBetween(const int min, const int max)
+{
+	if (max <= min)
+		return min;
+
+	// scales the number into the range with a multiply rather than a %
+	unsigned long long range = (unsigned int)(max - min);
+	return min + (int)((next() * range) >> 32);
+}
+
+float Random::randBetween(const float min, const float max)
+{
+	return min + (max - min) * toUnitFloat(next());
+}
+
+void Random::fill(float* out, const int count, const float min,
+	const float max)
+{
+	const float scale = max - min;
+	for (int i = 0; i < count; ++i)
+		out[i] = min + scale * toUnitFloat(next());
 }
\ No newline at end of file
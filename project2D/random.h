@@ -1,22 +1,81 @@
 #pragma once
 
-//------------------------------------------------------------------------
-// Gets a random integer within specified bounds
-//
-// Param: 
-//			min: minimum bounds of the random number
-//			max: maximum bounds of the random number
-// Return: 
-//			a random integer between min and max
-//------------------------------------------------------------------------
-int randBetween(int min, int max);
-//------------------------------------------------------------------------
-// Gets a random float within specified bounds
-//
-// Param: 
-//			min: minimum bounds of the random number
-//			max: maximum bounds of the random number
-// Return: 
-//			a random float between min and max
-//------------------------------------------------------------------------
-float randBetween(float min, float max);
\ No newline at end of file
+// the separate streams of random numbers, so one part of the game using
+//   more or fewer numbers doesn't change what any other part gets
+enum RandomStream
+{
+	RANDOMSTREAM_GROWTH = 0,	// which zoned tiles grow buildings
+	RANDOMSTREAM_BUILDINGS,		// removing invalid buildings and building timers
+	RANDOMSTREAM_SAVE,			// how loaded buildings drop in
+	RANDOMSTREAM_CAMERA,		// screen shake
+	RANDOMSTREAM_PARTICLES,		// particle velocities and fading
+
+	RANDOMSTREAM_COUNT // the total number of streams
+};
+
+// a small, fast random number generator (xoshiro128**)
+// each one only holds 16 bytes, so jobs can make their own rather than
+//   sharing one between threads, which isn't safe
+class Random
+{
+public:
+	//------------------------------------------------------------------------
+	// (explicit because we don't want any implicit conversion)
+	//
+	// Param:
+	//			seed:   the same seed always gives the same numbers
+	//			stream: which of the seed's independent streams to use,
+	//					e.g. a RandomStream or the index of a job
+	//------------------------------------------------------------------------
+	explicit Random(unsigned int seed = 0, unsigned int stream = 0);
+
+	//------------------------------------------------------------------------
+	// Starts the generator again from a seed
+	//
+	// Param:
+	//			seed:   the same seed always gives the same numbers
+	//			stream: which of the seed's independent streams to use
+	//------------------------------------------------------------------------
+	void seed(unsigned int seed, unsigned int stream = 0);
+
+	//------------------------------------------------------------------------
+	// Gets the next random number
+	//
+	// Return:
+	//			a random number using all 32 bits
+	//------------------------------------------------------------------------
+	unsigned int next();
+	//------------------------------------------------------------------------
+	// Gets a random integer within specified bounds
+	//
+	// Param: 
+	//			min: minimum bounds of the random number
+	//			max: maximum bounds of the random number, never returned
+	// Return: 
+	//			a random integer from min up to (but not including) max
+	//------------------------------------------------------------------------
+	int randBetween(int min, int max);
+	//------------------------------------------------------------------------
+	// Gets a random float within specified bounds
+	//
+	// Param: 
+	//			min: minimum bounds of the random number
+	//			max: maximum bounds of the random number
+	// Return: 
+	//			a random float between min and max
+	//------------------------------------------------------------------------
+	float randBetween(float min, float max);
+	//------------------------------------------------------------------------
+	// Fills an array with random floats within specified bounds
+	// Quicker than calling randBetween for each one
+	//
+	// Param: 
+	//			out:   the array to fill
+	//			count: how many floats to fill in
+	//			min:   minimum bounds of the random numbers
+	//			max:   maximum bounds of the random numbers
+	//------------------------------------------------------------------------
+	void fill(float* out, int count, float min, float max);
+private:
+	unsigned int m_state[4];
+};
\ No newline at end of file
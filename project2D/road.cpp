@@ -1,12 +1,13 @@
 #include "road.h"
 
-#include "game.h"
+#include "tilegrid.h"
+#include "simulation.h"
 #include "imagemanager.h"
 
-Road::Road(Game* game, int x, int y)
-	: Building(game, x, y)
+Road::Road(Simulation* sim, int x, int y)
+	: Building(sim, x, y)
 {
-	m_texture = m_game->getImageManager()->getTexture("buildings/road_right");
+	m_sprite = m_sim->getImageManager()->getSprite(SPRITE_ROAD_RIGHT);
 
 	m_price = 10;
 
@@ -21,14 +22,14 @@ void Road::draw(aie::Renderer2D* renderer)
 
 	const float xOrigin = 0.5f;
 	const float yOrigin = 0.0f;
-	renderer->drawSprite(m_texture, m_worldPos.getX(),
-		m_worldPos.getY() - 4 + m_altitude, 0, 0, 0, 0, xOrigin, yOrigin);
+	m_sprite->draw(renderer, m_worldPos.getX(),
+		m_worldPos.getY() - 4 + m_altitude, 0, 0, xOrigin, yOrigin);
 }
 
-// used for sorting
+// used to look roads up in RoadManager's per-tile arrays
 // turns the indices used in a 2 dimensional array (x, y)
 //   into a single index as if it was in a 1D array
 int Road::getOneDimensionalIndex() const
 {
-	return (m_posY * WORLD_WIDTH) + m_posX;
+	return m_sim->getTiles()->getIndex(m_posX, m_posY);
 }
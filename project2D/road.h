@@ -5,7 +5,7 @@
 class Road : public Building
 {
 public:
-	Road(Game* game, int x, int y);
+	Road(Simulation* sim, int x, int y);
 
 	void draw(aie::Renderer2D* renderer) override;
 
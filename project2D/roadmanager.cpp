@@ -1,16 +1,26 @@
 #include "roadmanager.h"
 
+#include <cstdio>
+#include <climits>
 #include <iostream>
 
-#include "game.h"
+#include "Profiler.h"
+
 #include "road.h"
 #include "darray.h"
+#include "tilegrid.h"
+#include "simulation.h"
 #include "imagemanager.h"
 
-RoadManager::RoadManager(Game* game)
+RoadManager::RoadManager(Simulation* sim)
 {
-	m_game = game;
+	m_sim = sim;
 	m_roads = new RoadList;
+
+	buildRoadSpriteTable();
+
+	// no roads yet so everything is infinitely far away
+	clearRoads();
 }
 
 RoadManager::~RoadManager()
@@ -23,165 +33,297 @@ void RoadManager::addRoad(Building* newRoad, bool sort)
 	if (newRoad->getType() != BUILDINGTYPE_ROAD)
 		return;
 
-	m_roads->add((Road*)newRoad);
+	int newPosX, newPosY;
+	newRoad->getPosition(&newPosX, &newPosY);
+	if (newPosX >= m_worldWidth || newPosY >= m_worldHeight
+		|| newPosX < 0 || newPosY < 0)
+		return;
 
-	if (!sort)
+	// there can only be one road on each tile
+	int tileIndex = (newPosY*m_worldWidth) + newPosX;
+	if (m_roadHandles[tileIndex] >= 0)
 		return;
 
-	// update textures if there's one adjacent to this new one
-	bool isAdjacent = false;
-	int newPosX, newPosY;
-	newRoad->getPosition(&newPosX, &newPosY);
-	for (int i = -1; i <= 1; ++i)
+	m_roadHandles[tileIndex] = m_roads->getCount();
+	m_roadBits[tileIndex / 32] |= 1u << (tileIndex % 32);
+	m_roads->add((Road*)newRoad);
+
+	if (!sort)
 	{
-		Road* adjHorz = getRoadAtPosition(newPosX + i, newPosY);
-		Road* adjVert = getRoadAtPosition(newPosX, newPosY + i);
-		if (adjHorz || adjVert)
-		{
-			isAdjacent = true;
-			break;
-		}
+		// textures and distances will be updated all at once by updateRoads
+		m_distanceDirty = true;
+		return;
 	}
-	if (isAdjacent)
-		updateRoadTextures();
+
+	if (!m_distanceDirty)
+		addRoadDistance(newPosX, newPosY);
+
+	updateRoadTexturesAround(newPosX, newPosY);
 }
 
 void RoadManager::updateRoads()
 {
-	// sort
-	int roadCount = m_roads->getCount();
-	quickSortRoads(0, roadCount - 1);
+	PROFILE_ZONE("RoadManager::updateRoads");
+
 	updateRoadTextures();
+
+	if (m_distanceDirty)
+		rebuildRoadDistance();
 }
 
 void RoadManager::removeRoad(Building* road)
 {
-	// remove our copy of this road pointer
-	m_roads->remove((Road*)road);
+	int posX, posY;
+	road->getPosition(&posX, &posY);
 
-	updateRoadTextures();
+	// make sure it's actually the road we know about
+	if (getRoadAtPosition(posX, posY) != road)
+		return;
+
+	// fill its slot with the last road so the list stays packed
+	int tileIndex = (posY*m_worldWidth) + posX;
+	int handle = m_roadHandles[tileIndex];
+	int last = m_roads->getCount() - 1;
+	Road* lastRoad = (*m_roads)[last];
+	(*m_roads)[handle] = lastRoad;
+	m_roadHandles[lastRoad->getOneDimensionalIndex()] = handle;
+	m_roads->remove(last);
+
+	m_roadHandles[tileIndex] = -1;
+	m_roadBits[tileIndex / 32] &= ~(1u << (tileIndex % 32));
+
+	if (!m_distanceDirty)
+		removeRoadDistance(posX, posY);
+
+	updateRoadTexturesAround(posX, posY);
 }
 
-void RoadManager::clearRoads() const
+void RoadManager::clearRoads()
 {
 	m_roads->clear();
+
+	m_worldWidth = m_sim->getTiles()->getWidth();
+	m_worldHeight = m_sim->getTiles()->getHeight();
+	m_roadDistance.assign(m_worldWidth * m_worldHeight, INT_MAX);
+	m_distanceDirty = false;
+
+	m_roadBits.assign((m_worldWidth * m_worldHeight + 31) / 32, 0);
+	m_roadHandles.assign(m_worldWidth * m_worldHeight, -1);
 }
 
-// binary search for road at the given position
 Road* RoadManager::getRoadAtPosition(const int x, const int y) const
 {
 	// make sure index is within bounds of world
-	if (x >= WORLD_WIDTH || y >= WORLD_HEIGHT
+	if (x >= m_worldWidth || y >= m_worldHeight
 		|| x < 0 || y < 0)
 		return nullptr;
 
-	// no roads to search for!
-	if (m_roads->getCount() < 1)
+	int handle = m_roadHandles[(y*m_worldWidth) + x];
+	if (handle < 0)
 		return nullptr;
 
-	// roads are sorted by (y*width)+x, like how they would be laid out in
-	//   a 1d array, so we get that as our target
-	int targetIndex = (y*WORLD_WIDTH) + x;
+	return (*m_roads)[handle];
+}
+
+bool RoadManager::hasRoadAt(const int x, const int y) const
+{
+	if (x >= m_worldWidth || y >= m_worldHeight
+		|| x < 0 || y < 0)
+		return false;
+
+	int tileIndex = (y*m_worldWidth) + x;
+	return (m_roadBits[tileIndex / 32] >> (tileIndex % 32)) & 1;
+}
 
-	// binary search time
-	int min = -1;
-	int max = m_roads->getCount();
-	int mid = max / 2;
+Road* RoadManager::getClosestRoad(const int x, const int y, 
+	int* distOut)
+{
+	int dist = getRoadDistance(x, y);
+	*distOut = dist;
+	if (dist == INT_MAX)
+		return nullptr;
 
-	// grab the index of the mid road
-	int midX, midY;
-	(*m_roads)[mid]->getPosition(&midX, &midY);
-	int midIndex = (midY*WORLD_WIDTH) + midX;
-	while (midIndex != targetIndex)
+	// walk downhill through the distances until we land on the road
+	int walkX = x;
+	int walkY = y;
+	const int stepX[4] = { 1, -1, 0, 0 };
+	const int stepY[4] = { 0, 0, 1, -1 };
+	while (dist > 0)
 	{
-		// adjust the search parameters based on the index of the road
-		if (midIndex < targetIndex)
-			min = mid;
-		else if (midIndex > targetIndex)
-			max = mid;
-		mid = (min + max) / 2;
-
-		// check if there's no more to search - road doesn't exist at index
-		if (max - min <= 1)
-			break;
-
-		// update the road index
-		Road* midRoad = (*m_roads)[mid];
-		midRoad->getPosition(&midX, &midY);
-		midIndex = (midY*WORLD_WIDTH) + midX;
+		for (int i = 0; i < 4; ++i)
+		{
+			if (getRoadDistance(walkX + stepX[i], walkY + stepY[i]) == dist - 1)
+			{
+				walkX += stepX[i];
+				walkY += stepY[i];
+				break;
+			}
+		}
+		dist--;
 	}
 
-	// road was found! return it
-	if (midIndex == targetIndex)
-		return (*m_roads)[mid];
+	return getRoadAtPosition(walkX, walkY);
+}
+
+int RoadManager::getRoadDistance(const int x, const int y)
+{
+	if (x >= m_worldWidth || y >= m_worldHeight
+		|| x < 0 || y < 0)
+		return INT_MAX;
+
+	if (m_distanceDirty)
+		rebuildRoadDistance();
 
-	// wasn't found
-	return nullptr;
+	return m_roadDistance[(y*m_worldWidth) + x];
 }
 
-Road* RoadManager::getClosestRoad(const int x, const int y, 
-	int* distOut) const
+void RoadManager::updateRoadDistance()
+{
+	if (m_distanceDirty)
+		rebuildRoadDistance();
+}
+
+// works out every tile's distance from scratch, starting from every road
+//   at once
+void RoadManager::rebuildRoadDistance()
 {
-	Road* closest = nullptr;
-	int closestDist = INT_MAX;
+	m_roadDistance.assign(m_worldWidth * m_worldHeight, INT_MAX);
 
+	std::vector<int> queue;
 	for (int i = 0; i < m_roads->getCount(); ++i)
 	{
-		Road* r = (*m_roads)[i];
-		int rx, ry;
-		r->getPosition(&rx, &ry);
-		auto xDist = (int)fabsf((float)x - rx);
-		auto yDist = (int)fabsf((float)y - ry);
-		int totalDist = xDist + yDist;
-		if (totalDist < closestDist)
+		int index = (*m_roads)[i]->getOneDimensionalIndex();
+		m_roadDistance[index] = 0;
+		queue.push_back(index);
+	}
+	spreadRoadDistance(queue);
+
+	m_distanceDirty = false;
+}
+
+// a new road can only bring tiles closer, so spread out from it until
+//   tiles are already as close to another road
+void RoadManager::addRoadDistance(const int x, const int y)
+{
+	int index = (y*m_worldWidth) + x;
+	if (m_roadDistance[index] == 0)
+		return;
+
+	m_roadDistance[index] = 0;
+	std::vector<int> queue;
+	queue.push_back(index);
+	spreadRoadDistance(queue);
+}
+
+// tiles which were closest to the removed road get wiped, then filled back
+//   in from the tiles around them which were closer to other roads
+void RoadManager::removeRoadDistance(const int x, const int y)
+{
+	const int stepX[4] = { 1, -1, 0, 0 };
+	const int stepY[4] = { 0, 0, 1, -1 };
+
+	// anything whose distance is exactly its distance to the removed road
+	//   might have been relying on it
+	// these tiles are always connected to the road so we can search outwards
+	std::vector<int> region;
+	region.push_back((y*m_worldWidth) + x);
+	m_roadDistance[region[0]] = INT_MAX;
+	for (size_t i = 0; i < region.size(); ++i)
+	{
+		int cx = region[i] % m_worldWidth;
+		int cy = region[i] / m_worldWidth;
+		int oldDist = abs(cx - x) + abs(cy - y);
+
+		for (int s = 0; s < 4; ++s)
 		{
-			closest = r;
-			closestDist = totalDist;
+			int nx = cx + stepX[s];
+			int ny = cy + stepY[s];
+			if (nx >= m_worldWidth || ny >= m_worldHeight || nx < 0 || ny < 0)
+				continue;
+			// only step away from the road
+			if (abs(nx - x) + abs(ny - y) != oldDist + 1)
+				continue;
+
+			int nIndex = (ny*m_worldWidth) + nx;
+			if (m_roadDistance[nIndex] != oldDist + 1)
+				continue;
+
+			m_roadDistance[nIndex] = INT_MAX;
+			region.push_back(nIndex);
 		}
 	}
 
-	*distOut = closestDist;
-	return closest;
+	// the tiles bordering the wiped area still have correct distances
+	std::vector<int> queue;
+	for (auto index : region)
+	{
+		int cx = index % m_worldWidth;
+		int cy = index / m_worldWidth;
+		for (int s = 0; s < 4; ++s)
+		{
+			int nx = cx + stepX[s];
+			int ny = cy + stepY[s];
+			if (nx >= m_worldWidth || ny >= m_worldHeight || nx < 0 || ny < 0)
+				continue;
+
+			int nIndex = (ny*m_worldWidth) + nx;
+			if (m_roadDistance[nIndex] != INT_MAX)
+				queue.push_back(nIndex);
+		}
+	}
+	spreadRoadDistance(queue);
 }
 
-void RoadManager::updateRoadTextures() const
+// breadth-first search outwards, lowering any distances it can
+void RoadManager::spreadRoadDistance(std::vector<int>& queue)
 {
-	// update road textures based on neighbouring roads
-	for (int i = 0; i < m_roads->getCount(); ++i)
+	const int stepX[4] = { 1, -1, 0, 0 };
+	const int stepY[4] = { 0, 0, 1, -1 };
+
+	for (size_t i = 0; i < queue.size(); ++i)
 	{
-		Road* r = (*m_roads)[i];
-		// grab the road positions
-		int ix, iy;
-		r->getPosition(&ix, &iy);
+		int cx = queue[i] % m_worldWidth;
+		int cy = queue[i] / m_worldWidth;
+		int newDist = m_roadDistance[queue[i]] + 1;
 
-		// use a bitfield to hold which sides are connected
-		// 0bUDLR
-		// U = y-1, D = y+1, L = x-1, R = x+1
-		char connectField = 0;
-		if (getRoadAtPosition(ix, iy - 1)) // road is above
-			connectField |= 0b1000;
-		if (getRoadAtPosition(ix, iy + 1)) // road is below
-			connectField |= 0b0100;
-		if (getRoadAtPosition(ix - 1, iy)) // road is to the left
-			connectField |= 0b0010;
-		if (getRoadAtPosition(ix + 1, iy)) // road is to the right
-			connectField |= 0b0001;
+		for (int s = 0; s < 4; ++s)
+		{
+			int nx = cx + stepX[s];
+			int ny = cy + stepY[s];
+			if (nx >= m_worldWidth || ny >= m_worldHeight || nx < 0 || ny < 0)
+				continue;
+
+			int nIndex = (ny*m_worldWidth) + nx;
+			if (m_roadDistance[nIndex] <= newDist)
+				continue;
+
+			m_roadDistance[nIndex] = newDist;
+			queue.push_back(nIndex);
+		}
+	}
+}
 
+void RoadManager::buildRoadSpriteTable()
+{
+	ImageManager* images = m_sim->getImageManager();
+
+	for (int connectField = 0; connectField < ROAD_MASK_COUNT; ++connectField)
+	{
 		// straight up/down
-		// field is either 0b1000, 0b0100 or 0b1100
+		// field is either 0b1000, 0b0100, 0b1100 or 0b0000
 		if (connectField % 4 == 0)
 		{
-			r->setTexture(m_game->getImageManager()->getTexture(
-				"buildings/road_left"));
+			m_roadSprites[connectField] =
+				images->getSprite(SPRITE_ROAD_LEFT);
 			continue;
 		}
 
 		// straight left/right
-		// field is either 0b0001, 0b0010, 0b0011 or 0b0000
+		// field is either 0b0001, 0b0010 or 0b0011
 		if (connectField <= 0b0011)
 		{
-			r->setTexture(m_game->getImageManager()->getTexture(
-				"buildings/road_right"));
+			m_roadSprites[connectField] =
+				images->getSprite(SPRITE_ROAD_RIGHT);
 			continue;
 		}
 
@@ -190,53 +332,62 @@ void RoadManager::updateRoadTextures() const
 		//   (this tile is surrounded by roads)
 		if (connectField == 0b1111)
 		{
-			r->setTexture(m_game->getImageManager()->getTexture(
-				"buildings/road_intersection"));
+			m_roadSprites[connectField] =
+				images->getSprite(SPRITE_ROAD_INTERSECTION);
 			continue;
 		}
 
 		// if nothing else was done, we can use the result of the field in the 
 		// filename
 		char texName[64];
-		sprintf_s(texName, 64, "buildings/road_turn%d", connectField);
-		r->setTexture(m_game->getImageManager()->getTexture(texName));
+		snprintf(texName, 64, "buildings/road_turn%d", connectField);
+		m_roadSprites[connectField] = images->getSprite(texName);
 	}
 }
 
-void RoadManager::quickSortRoads(const int min, const int max) const
+int RoadManager::getRoadMask(const int x, const int y) const
+{
+	// use a bitfield to hold which sides are connected
+	// 0bUDLR
+	// U = y-1, D = y+1, L = x-1, R = x+1
+	int connectField = 0;
+	if (hasRoadAt(x, y - 1)) // road is above
+		connectField |= 0b1000;
+	if (hasRoadAt(x, y + 1)) // road is below
+		connectField |= 0b0100;
+	if (hasRoadAt(x - 1, y)) // road is to the left
+		connectField |= 0b0010;
+	if (hasRoadAt(x + 1, y)) // road is to the right
+		connectField |= 0b0001;
+
+	return connectField;
+}
+
+void RoadManager::updateRoadTextures() const
 {
-	if (min < max)
+	// update road textures based on neighbouring roads
+	for (int i = 0; i < m_roads->getCount(); ++i)
 	{
-		int p = partitionRoads(min, max);
-		// now sort both sides of the partition index
-		quickSortRoads(min, p - 1);
-		quickSortRoads(p + 1, max);
+		Road* r = (*m_roads)[i];
+		// grab the road positions
+		int ix, iy;
+		r->getPosition(&ix, &iy);
+
+		r->setSprite(m_roadSprites[getRoadMask(ix, iy)]);
 	}
 }
 
-// based on pseudocode from the Lomuto partition scheme:
-// https://en.wikipedia.org/wiki/Quicksort#Lomuto_partition_scheme
-int RoadManager::partitionRoads(const int min, const int max) const
+void RoadManager::updateRoadTexturesAround(const int x, const int y) const
 {
-	// use last road as the pivot
-	Road* pivot = (*m_roads)[max];
-	int pivIndex = pivot->getOneDimensionalIndex();
-
-	int i = min - 1;
-	for (int j = min; j < max; ++j)
+	// the tile itself, then up, down, left and right
+	const int stepX[5] = { 0, 0, 0, -1, 1 };
+	const int stepY[5] = { 0, -1, 1, 0, 0 };
+	for (int i = 0; i < 5; ++i)
 	{
-		int thisIndex = (*m_roads)[j]->getOneDimensionalIndex();
-		if (thisIndex < pivIndex)
-		{
-			i++;
-			// swap
-			Road* iRoad = (*m_roads)[i];
-			(*m_roads)[i] = (*m_roads)[j];
-			(*m_roads)[j] = iRoad;
-		}
+		int ix = x + stepX[i];
+		int iy = y + stepY[i];
+		Road* r = getRoadAtPosition(ix, iy);
+		if (r)
+			r->setSprite(m_roadSprites[getRoadMask(ix, iy)]);
 	}
-	// put the pivot in its place
-	(*m_roads)[max] = (*m_roads)[i + 1];
-	(*m_roads)[i + 1] = pivot;
-	return i + 1;
-}
+}
\ No newline at end of file
@@ -1,12 +1,19 @@
 #pragma once
 
+#include <vector>
+
 // Forward declares
 template <class T>
 class DArray;
 
 class Building;
-class Game;
+class Simulation;
 class Road;
+struct Sprite;
+
+// roads pick their picture from which of their 4 sides have roads next to
+//   them, so there are 16 possible pictures
+#define ROAD_MASK_COUNT 16
 
 // typedef for shorter typing
 typedef DArray<Road*> RoadList;
@@ -16,9 +23,9 @@ class RoadManager
 public:
 	//------------------------------------------------------------------------
 	// Param:
-	//			game:		pointer to our Game so we can access everything
+	//			sim:		pointer to our Simulation so we can access everything
 	//------------------------------------------------------------------------
-	explicit RoadManager(Game* game);
+	explicit RoadManager(Simulation* sim);
 	~RoadManager();
 
 	// we don't expect RoadManager to be copied/moved
@@ -33,7 +40,8 @@ public:
 	//
 	// Param: 
 	//			newRoad: pointer to the road we're adding
-	//			sort:	 whether or not to sort the list of roads
+	//			sort:	 whether or not to update textures and distances now,
+	//					 if not updateRoads should be called after a batch
 	//------------------------------------------------------------------------
 	void addRoad(Building* newRoad, bool sort = true);
 	//------------------------------------------------------------------------
@@ -46,18 +54,21 @@ public:
 	void removeRoad(Building* road);
 	//------------------------------------------------------------------------
 	// Clears the list of roads
+	// Also resizes the road distances to fit the current world, so this
+	//   should be called after the world changes size
 	//------------------------------------------------------------------------
-	void clearRoads() const;
+	void clearRoads();
 
 	//------------------------------------------------------------------------
-	// Sorts the list of roads and updates their textures
-	// Should be called whenever a road is added/removed
+	// Updates every road's texture and the distances to roads
+	// Should be called after adding roads with sort turned off
 	//------------------------------------------------------------------------
 	void updateRoads();
 
 	//------------------------------------------------------------------------
 	// Gets the road at at a position
 	// Returns nullptr if there is no road at the position
+	// This is just a lookup so it's fine to call a lot
 	//
 	// Param: 
 	//			x: tile-based x position to look for
@@ -76,16 +87,64 @@ public:
 	// Return: 
 	//			pointer to the road closest to the position
 	//------------------------------------------------------------------------
-	Road* getClosestRoad(int x, int y, int* distOut) const;
+	Road* getClosestRoad(int x, int y, int* distOut);
+	//------------------------------------------------------------------------
+	// Gets how many tiles away the closest road is, counting only up/down
+	// and left/right steps
+	// This is just a lookup so it's fine to call a lot
+	//
+	// Param: 
+	//			x: tile-based x position to check
+	//			y: tile-based y position to check
+	// Return: 
+	//			distance to the closest road, INT_MAX if there are no roads
+	//------------------------------------------------------------------------
+	int getRoadDistance(int x, int y);
+	//------------------------------------------------------------------------
+	// Works out any road distances that are out of date
+	// getRoadDistance does this itself when needed, so this only has to be
+	//   called before reading distances from several threads at once
+	//------------------------------------------------------------------------
+	void updateRoadDistance();
 private:
-	Game* m_game;
+	Simulation* m_sim;
 
+	// every road, packed together in no particular order
 	RoadList* m_roads;
+	// one bit per tile, set if there's a road on it
+	std::vector<unsigned int> m_roadBits;
+	// index into m_roads of the road on each tile, or -1
+	std::vector<int> m_roadHandles;
 
-	// function which changes the roads' textures based on their neighbours
-	void updateRoadTextures() const;
+	// distance from each tile to its closest road, laid out like
+	//   getOneDimensionalIndex
+	std::vector<int> m_roadDistance;
+	// size of the world the distances were made for
+	int m_worldWidth, m_worldHeight;
+	// set when roads were added without updating the distances
+	bool m_distanceDirty;
+
+	// functions to keep m_roadDistance up to date
+	void rebuildRoadDistance();
+	void addRoadDistance(int x, int y);
+	void removeRoadDistance(int x, int y);
+	// spreads distances outwards from the tiles in the queue
+	void spreadRoadDistance(std::vector<int>& queue);
+
+	// picture for each connection mask, looked up once when we start
+	Sprite* m_roadSprites[ROAD_MASK_COUNT];
 
-	// sorting functions
-	void quickSortRoads(int min, int max) const;
-	int partitionRoads(int min, int max) const;
+	// fills in m_roadSprites
+	void buildRoadSpriteTable();
+	// gets which sides of a tile have roads, as 0bUDLR
+	int getRoadMask(int x, int y) const;
+
+	// whether there's a road on a tile, checking it's in the world
+	bool hasRoadAt(int x, int y) const;
+
+	// function which changes every road's texture based on its neighbours
+	void updateRoadTextures() const;
+	// changes the textures of the road at a position and the roads around
+	//   it, which are the only ones that can change when it's added/removed
+	void updateRoadTexturesAround(int x, int y) const;
 };
\ No newline at end of file
@@ -1,356 +1,608 @@
 #include "savemanager.h"
 
+#include <cstring>
+#include <fstream>
 #include <iostream>
 
-#include "game.h"
-#include "tile.h"
 #include "darray.h"
+#include "tilegrid.h"
 #include "building.h"
+#include "simulation.h"
 #include "roadmanager.h"
 #include "tilemanager.h"
 #include "buildingmanager.h"
 
-SaveManager::SaveManager(Game* game)
-	: m_game(game), m_headerSize(4 + 8 + 4 /* money + map size + building count */)
+SaveManager::SaveManager(Simulation* sim)
+	: m_sim(sim), m_compress(true), m_quiet(false), m_fileName(SAVEFILE_NAME)
 {
 }
 
 bool SaveManager::loadData()
 {
-	std::fstream file;
-	file.open(SAVEFILE_NAME, std::ios::in | std::ios::binary);
-	if (!file.is_open())
+	SaveData save;
+	if (!loadSaveData(save, "loading"))
+		return false;
+
+	if (!save.hasInfo || !save.hasZones || !save.hasBuildings)
 	{
-		printf("Couldn't open save file when loading!\n");
+		printf("Save file is missing some of the world!\n");
 		return false;
 	}
 
-	int worldHeight, worldWidth;
-	int buildingCount;
-
-	// start reading!
-
-	// load money
-	int tempMoney; // temp variable to store it in
-	file.read((char*)&tempMoney, 4);
-	m_game->setMoney(tempMoney); // then stick it into Game
-
-	// read the world size
-	file.read((char*)&worldWidth, 4);
-	file.read((char*)&worldHeight, 4);
-
-	// and building count
-	file.read((char*)&buildingCount, 4);
-
-	printf("Loading map of %dx%d tiles with %d buildings and $%d\n",
-		worldHeight, worldWidth, buildingCount, tempMoney);
+	if (!m_quiet)
+	{
+		printf("Loading map of %dx%d tiles with %d buildings and $%d\n",
+			save.info.worldWidth, save.info.worldHeight,
+			(int)save.buildings.size(), save.info.money);
+	}
 
 	// load all the tiles
-	readTiles(&file, worldWidth, worldHeight);
+	if (!applyTiles(save))
+		return false;
+
+	m_sim->setMoney(save.info.money);
 
-	// read em
-	readBuildings(&file, buildingCount);
+	// then the buildings, which are sorted as they're added
+	applyBuildings(save);
 
-	// and sort/update everything!
-	m_game->getBuildingManager()->sortBuildings();
-	m_game->getRoadManager()->updateRoads();
+	// and update the roads!
+	m_sim->getRoadManager()->updateRoads();
 
-	file.close();
 	return true;
 }
 
 bool SaveManager::saveData()
 {
-	/*
-		format stuff:
-		4 bytes: money
-		8 bytes: size of tiles (even though it's constant for now)
-			width
-			height
-		4 bytes: number of buildings
-		=================================
-		all tile info (zones)
-		----------------------
-		all buildings (x, y, type)
-	*/
-	std::fstream file;
-	file.open(SAVEFILE_NAME, std::ios::out | std::ios::binary);
-
-	if (!file.is_open())
+	SaveData save;
+	save.hasInfo = save.hasZones = save.hasBuildings = true;
+	storeInfo(save);
+	storeTiles(save);
+	storeBuildings(save);
+
+	std::vector<unsigned char> file;
+	buildFile(save, file);
+
+	if (!writeFile(file))
 	{
 		printf("Couldn't open save file when saving!!\n");
 		return false;
 	}
 
-	BuildingList* buildings = m_game->getBuildingManager()->getBuildings();
+	return true;
+}
 
-	int worldWidth = WORLD_WIDTH;
-	int worldHeight = WORLD_HEIGHT;
-	int buildingCount = (int)buildings->getCount();
+// the partial save/load functions below work on a single chunk, keeping
+//   everything else in the file as it was
 
-	// start writing!
+bool SaveManager::saveBuildings()
+{
+	SaveData save;
+	if (!loadSaveData(save, "saving buildings"))
+		return false;
 
-	// write money
-	int tempMoney = m_game->getMoney(); // get it in a temporary variable first
-	file.write((char*)&tempMoney, 4);
+	save.hasBuildings = true;
+	storeBuildings(save);
 
-	// write world width and height
-	file.write((char*)&worldWidth, 4);
-	file.write((char*)&worldHeight, 4);
+	std::vector<unsigned char> file;
+	buildFile(save, file);
+	return writeFile(file);
+}
 
-	// and now write the number of buildings
-	file.write((char*)&buildingCount, 4);
+bool SaveManager::saveTiles()
+{
+	SaveData save;
+	if (!loadSaveData(save, "saving tiles"))
+		return false;
 
-	// write all the tiles
-	writeTiles(&file, worldWidth, worldHeight);
+	save.hasZones = true;
+	storeTiles(save);
 
-	// and the buildings
-	writeBuildings(&file);
+	std::vector<unsigned char> file;
+	buildFile(save, file);
+	return writeFile(file);
+}
+
+bool SaveManager::loadBuildings()
+{
+	SaveData save;
+	if (!loadSaveData(save, "loading buildings"))
+		return false;
+
+	if (!save.hasBuildings)
+	{
+		printf("Save file has no buildings!\n");
+		return false;
+	}
+
+	printf("Loading %d buildings!\n", (int)save.buildings.size());
+
+	applyBuildings(save);
 
-	file.close();
 	return true;
 }
 
-// used in loadTiles so we know how many tiles to load
-void SaveManager::getWorldSize(int* width, int* height, std::fstream* openFile)
+bool SaveManager::loadTiles()
 {
-	// double check that the file is open
-	if (!openFile->is_open())
+	SaveData save;
+	if (!loadSaveData(save, "loading tiles"))
+		return false;
+
+	if (!save.hasInfo || !save.hasZones)
 	{
-		*width = -1;
-		*height = -1;
-		return;
+		printf("Save file has no tiles!\n");
+		return false;
 	}
 
-	// start of file is MONEY, WORLD WIDTH, WORLD HEIGHT, BUILDING COUNT
-	openFile->seekg(4, std::ios::beg); // skip past the money value
-	int tempWidth, tempHeight;
-	openFile->read((char*)&tempWidth, 4);
-	openFile->read((char*)&tempHeight, 4);
-
-	*width = tempWidth;
-	*height = tempHeight;
+	return applyTiles(save);
 }
 
-int SaveManager::getBuildingCount(std::fstream* openFile)
+bool SaveManager::readFile(std::vector<unsigned char>& file)
 {
-	// double check that the file is open
-	if (!openFile->is_open())
-		return -1;
+	std::fstream stream;
+	stream.open(m_fileName, std::ios::in | std::ios::binary);
+	if (!stream.is_open())
+		return false;
 
-	// start of file is MONEY, WORLD WIDTH, WORLD HEIGHT, BUILDING COUNT
-	openFile->seekg(12, std::ios::beg); // skip past money and world size
-	int count;
-	openFile->read((char*)&count, 4);
+	// find out how big it is so it can all be read at once
+	stream.seekg(0, std::ios::end);
+	std::streamoff size = stream.tellg();
+	stream.seekg(0, std::ios::beg);
+	if (size < 0)
+		return false;
 
-	return count;
+	file.resize((size_t)size);
+	if (size > 0)
+		stream.read((char*)file.data(), size);
+
+	return !stream.fail();
 }
 
-// reads tiles and sets them in the game, assuming the read
-// pointer is in the correct position
-void SaveManager::readTiles(std::fstream* openFile, int worldWidth, int worldHeight)
+bool SaveManager::writeFile(const std::vector<unsigned char>& file)
 {
-	// make sure tile list is fresh and sized properly
-	m_game->getTileManager()->clearTiles(worldWidth, worldHeight);
+	std::fstream stream;
+	stream.open(m_fileName, std::ios::out | std::ios::binary);
+	if (!stream.is_open())
+		return false;
+
+	stream.write((const char*)file.data(), file.size());
+
+	return !stream.fail();
+}
 
-	// read all tile zones
-	for (int y = 0; y < worldHeight; ++y)
+bool SaveManager::loadSaveData(SaveData& save, const char* what)
+{
+	std::vector<unsigned char> file;
+	if (!readFile(file))
 	{
-		for (int x = 0; x < worldWidth; ++x)
-		{
-			char zoneType;
-			openFile->read(&zoneType, 1);
-			m_game->getTileManager()->getTile(x, y)->setZoneType((ZoneType)zoneType);
-		}
+		printf("Couldn't open save file when %s!\n", what);
+		return false;
 	}
+
+	return parseFile(file, save);
 }
 
-// reads buildings and adds them to the game, assuming the read
-// pointer is in the correct position
-void SaveManager::readBuildings(std::fstream* openFile, int buildingCount)
+bool SaveManager::parseFile(const std::vector<unsigned char>& file,
+	SaveData& save)
 {
-	// clear buildings and pointers to any roads before loading
-	m_game->getRoadManager()->clearRoads();
-	m_game->getBuildingManager()->clearBuildings();
+	save.hasInfo = save.hasZones = save.hasBuildings = false;
 
-	// randomly choose the direction to drop buildings in
-	bool horz = (rand() % 100) < 50;
+	if (file.size() < sizeof(SaveHeader)
+		|| memcmp(file.data(), SAVE_MAGIC, 4) != 0)
+		return parseLegacyFile(file, save);
 
-	for (int i = 0; i < buildingCount; ++i)
+	SaveHeader header;
+	memcpy(&header, file.data(), sizeof(SaveHeader));
+	if (header.version > SAVE_VERSION)
 	{
-		// building info we stored
-		short buildingType;
-		int buildingX, buildingY;
+		printf("Save file is version %u, but only up to %d is supported!\n",
+			header.version, SAVE_VERSION);
+		return false;
+	}
 
-		// read em
-		openFile->read((char*)&buildingType, 2);
-		openFile->read((char*)&buildingX, 4);
-		openFile->read((char*)&buildingY, 4);
+	size_t pos = sizeof(SaveHeader);
+	std::vector<unsigned char> data;
+	for (unsigned int i = 0; i < header.chunkCount; ++i)
+	{
+		SaveChunkHeader chunk;
+		if (file.size() - pos < sizeof(SaveChunkHeader))
+		{
+			printf("Save file ends in the middle of a chunk!\n");
+			return false;
+		}
+		memcpy(&chunk, file.data() + pos, sizeof(SaveChunkHeader));
+		pos += sizeof(SaveChunkHeader);
 
-		// make a new building with these values
-		Building* build = m_game->getBuildingManager()->makeBuilding(
-			(BuildingType)buildingType, buildingX, buildingY);
+		if (file.size() - pos < chunk.storedSize)
+		{
+			printf("Save file ends in the middle of a chunk!\n");
+			return false;
+		}
+		const unsigned char* stored = file.data() + pos;
+		pos += chunk.storedSize;
 
-		// set altitude stuff to drop row-by-row
-		int dropDir = buildingX;
-		if (!horz)
-			dropDir = buildingY;
+		if (memcmp(chunk.id, SAVECHUNK_INFO, 4) == 0)
+		{
+			if (chunk.size != sizeof(SaveInfo) || !readChunk(chunk, stored, data))
+				return false;
+			memcpy(&save.info, data.data(), sizeof(SaveInfo));
+			save.hasInfo = true;
+		}
+		else if (memcmp(chunk.id, SAVECHUNK_ZONES, 4) == 0)
+		{
+			if (!readChunk(chunk, stored, save.zones))
+				return false;
+			save.hasZones = true;
+		}
+		else if (memcmp(chunk.id, SAVECHUNK_BUILDINGS, 4) == 0)
+		{
+			if (chunk.size % sizeof(SaveBuildingRecord) != 0
+				|| !readChunk(chunk, stored, data))
+				return false;
+			save.buildings.resize(chunk.size / sizeof(SaveBuildingRecord));
+			if (chunk.size > 0)
+				memcpy(save.buildings.data(), data.data(), chunk.size);
+			save.hasBuildings = true;
+		}
+		// anything else is from a newer version, so just skip it
+	}
 
-		// I was going to make sure they're on the ground but this is
-		//   more fun
-		build->setAltitude(dropDir * 500.0f);
+	if (save.hasInfo && save.hasZones && save.zones.size()
+		!= (size_t)save.info.worldWidth * save.info.worldHeight)
+	{
+		printf("Save file's zones don't match its world size!\n");
+		return false;
+	}
+
+	return true;
+}
+
+bool SaveManager::parseLegacyFile(const std::vector<unsigned char>& file,
+	SaveData& save)
+{
+	// old saves were just a few ints then the zones and buildings, and
+	//   the only way to tell the versions apart is by which one adds up
+	//   to the size of the file
+	const size_t recordSize = 2 + 4 + 4;
+	int values[4];
+	if (file.size() < sizeof(values))
+	{
+		printf("Save file is too small!\n");
+		return false;
+	}
+	memcpy(values, file.data(), sizeof(values));
 
-		m_game->getBuildingManager()->addBuilding(build, false);
+	size_t headerSize = 0;
+	for (int version = 1; version >= 0 && headerSize == 0; --version)
+	{
+		// version 1 has money first
+		const int* sizes = values + version;
+		if (!isWorldSizeValid(sizes[0], sizes[1]) || sizes[2] < 0)
+			continue;
+
+		size_t expected = (version + 3) * 4
+			+ (size_t)sizes[0] * sizes[1] + sizes[2] * recordSize;
+		if (expected != file.size())
+			continue;
+
+		headerSize = (version + 3) * 4;
+		save.info.money = version == 1 ? values[0] : m_sim->getMoney();
+		save.info.worldWidth = sizes[0];
+		save.info.worldHeight = sizes[1];
+		save.info.buildingCount = sizes[2];
+	}
+
+	if (headerSize == 0)
+	{
+		printf("Save file isn't in any format we know!\n");
+		return false;
 	}
+
+	size_t tileCount = (size_t)save.info.worldWidth * save.info.worldHeight;
+	const unsigned char* pos = file.data() + headerSize;
+	save.zones.assign(pos, pos + tileCount);
+	pos += tileCount;
+
+	// buildings were written field by field, so they aren't aligned
+	save.buildings.resize(save.info.buildingCount);
+	for (auto& record : save.buildings)
+	{
+		memcpy(&record.type, pos, 2);
+		memcpy(&record.x, pos + 2, 4);
+		memcpy(&record.y, pos + 6, 4);
+		record.padding = 0;
+		pos += recordSize;
+	}
+
+	save.hasInfo = save.hasZones = save.hasBuildings = true;
+	return true;
 }
 
-// writes tiles to openFile, assuming the write 
-// pointer is in the correct position
-void SaveManager::writeTiles(std::fstream* openFile, int worldWidth, int worldHeight)
+void SaveManager::buildFile(const SaveData& save,
+	std::vector<unsigned char>& file)
 {
-	// write all the tiles' zones, 1 byte each
-	for (int y = 0; y < worldHeight; ++y)
+	SaveHeader header;
+	memcpy(header.magic, SAVE_MAGIC, 4);
+	header.version = SAVE_VERSION;
+	header.chunkCount = (save.hasInfo ? 1 : 0) + (save.hasZones ? 1 : 0)
+		+ (save.hasBuildings ? 1 : 0);
+
+	file.clear();
+	file.insert(file.end(), (const unsigned char*)&header,
+		(const unsigned char*)&header + sizeof(SaveHeader));
+
+	if (save.hasInfo)
+		writeChunk(file, SAVECHUNK_INFO, &save.info, sizeof(SaveInfo));
+	if (save.hasZones)
 	{
-		for (int x = 0; x < worldWidth; ++x)
-		{
-			Tile* thisTile = m_game->getTileManager()->getTile(x, y);
-			char zoneType = thisTile->getZoneType();
-			openFile->write((char*)&zoneType, 1);
-		}
+		writeChunk(file, SAVECHUNK_ZONES, save.zones.data(),
+			(unsigned int)save.zones.size());
 	}
+	if (save.hasBuildings)
+	{
+		writeChunk(file, SAVECHUNK_BUILDINGS, save.buildings.data(),
+			(unsigned int)(save.buildings.size() * sizeof(SaveBuildingRecord)));
+	}
+}
+
+bool SaveManager::isWorldSizeValid(int width, int height) const
+{
+	return width > 0 && height > 0
+		&& width <= MAX_WORLD_SIZE && height <= MAX_WORLD_SIZE;
+}
+
+void SaveManager::storeInfo(SaveData& save)
+{
+	save.info.money = m_sim->getMoney();
+	save.info.worldWidth = m_sim->getWorldWidth();
+	save.info.worldHeight = m_sim->getWorldHeight();
+	save.info.buildingCount = m_sim->getBuildingManager()->getBuildings()->getCount();
 }
 
-void SaveManager::writeBuildings(std::fstream* openFile)
+void SaveManager::storeTiles(SaveData& save)
 {
-	BuildingList* buildings = m_game->getBuildingManager()->getBuildings();
+	int worldWidth = m_sim->getWorldWidth();
+	int worldHeight = m_sim->getWorldHeight();
+	save.info.worldWidth = worldWidth;
+	save.info.worldHeight = worldHeight;
+
+	// zones are 1 byte each in the same order as the grid, so they can be
+	//   copied straight out
+	const unsigned char* zones = m_sim->getTiles()->getZoneData();
+	save.zones.assign(zones, zones + worldWidth * worldHeight);
+}
+
+void SaveManager::storeBuildings(SaveData& save)
+{
+	BuildingList* buildings = m_sim->getBuildingManager()->getBuildings();
 	int buildingCount = buildings->getCount();
+	save.info.buildingCount = buildingCount;
 
-	// 2 bytes for type, 8 bytes for position
+	save.buildings.resize(buildingCount);
 	for (int i = 0; i < buildingCount; ++i)
 	{
-		Building* thisBuilding = (*buildings)[i];
-		short buildingType = thisBuilding->getType();
-		int buildingX, buildingY;
-		thisBuilding->getPosition(&buildingX, &buildingY);
-
-		// write these
-		openFile->write((char*)&buildingType, 2); // building ID
-		openFile->write((char*)&buildingX, 4); // x position
-		openFile->write((char*)&buildingY, 4); // y position
+		SaveBuildingRecord& record = save.buildings[i];
+		record.type = (short)(*buildings)[i]->getType();
+		record.padding = 0;
+		(*buildings)[i]->getPosition(&record.x, &record.y);
 	}
 }
 
-// below functions are just to demonstrate reading/writing from random points
-
-bool SaveManager::saveBuildings()
+// sets the zones in the game, making a new world if the size changed
+bool SaveManager::applyTiles(const SaveData& save)
 {
-	std::fstream file;
-	file.open(SAVEFILE_NAME, std::ios::in | std::ios::out | std::ios::binary);
-
-	if (!file.is_open())
+	int worldWidth = save.info.worldWidth;
+	int worldHeight = save.info.worldHeight;
+	if (!isWorldSizeValid(worldWidth, worldHeight)
+		|| save.zones.size() != (size_t)worldWidth * worldHeight)
 	{
-		printf("Couldn't open save file when saving buildings!!\n");
+		printf("Save file has a broken world size of %dx%d!\n",
+			worldWidth, worldHeight);
 		return false;
 	}
+	for (unsigned char zone : save.zones)
+	{
+		if (zone >= ZONETYPE_COUNT)
+		{
+			printf("Save file has a broken zone type of %d!\n", zone);
+			return false;
+		}
+	}
 
-	// grab world size so we know how far into the file to read
-	int worldWidth = WORLD_WIDTH;
-	int worldHeight = WORLD_HEIGHT;
-
-	BuildingList* buildings = m_game->getBuildingManager()->getBuildings();
-	int buildingCount = buildings->getCount();
-
-	// jump to where the building count is
-	file.seekp(m_headerSize - 4, std::ios::beg);
-	// and save it
-	file.write((char*)&buildingCount, 4);
-
-	// then jump past the tiles
-	file.seekp(m_headerSize + (worldWidth * worldHeight), std::ios::beg);
+	// a different sized world can't keep anything from the old one
+	// otherwise everything is kept and just the zones are replaced
+	if (worldWidth != m_sim->getWorldWidth()
+		|| worldHeight != m_sim->getWorldHeight())
+		m_sim->newWorld(worldWidth, worldHeight);
 
-	// write em
-	writeBuildings(&file);
+	m_sim->getTiles()->setZoneData(save.zones.data());
 
 	return true;
 }
 
-bool SaveManager::saveTiles()
+// replaces all the buildings in the game with the saved ones
+void SaveManager::applyBuildings(const SaveData& save)
 {
-	std::fstream file;
-	file.open(SAVEFILE_NAME, std::ios::in | std::ios::out | std::ios::binary);
+	BuildingManager* buildingManager = m_sim->getBuildingManager();
+
+	// clear buildings and pointers to any roads before loading
+	m_sim->getRoadManager()->clearRoads();
+	buildingManager->clearBuildings();
 
-	if (!file.is_open())
+	// randomly choose the direction to drop buildings in
+	bool horz = m_sim->getRandom(RANDOMSTREAM_SAVE).randBetween(0, 100) < 50;
+
+	// made first and then added all at once
+	std::vector<Building*> builds;
+	builds.reserve(save.buildings.size());
+	for (auto& record : save.buildings)
 	{
-		printf("Couldn't open save file when saving tiles!!\n");
-		return false;
-	}
+		// make a new building with these values
+		Building* build = buildingManager->makeBuilding(
+			(BuildingType)record.type, record.x, record.y);
+		if (!build)
+			continue;
 
-	// get the world size for writing
-	int worldWidth = WORLD_WIDTH;
-	int worldHeight = WORLD_HEIGHT;
-	// jump to the world size, just after the first integer
-	file.seekp(4, std::ios::beg);
-	// write the size
-	file.write((char*)&worldWidth, 4);
-	file.write((char*)&worldHeight, 4);
+		// set altitude stuff to drop row-by-row
+		int dropDir = record.x;
+		if (!horz)
+			dropDir = record.y;
 
-	// jump forward 4 bytes past the building count
-	file.seekp(4, std::ios::cur);
+		// I was going to make sure they're on the ground but this is
+		//   more fun
+		build->setAltitude(dropDir * 500.0f);
 
-	// now we can start writing the tiles!
-	writeTiles(&file, worldWidth, worldHeight);
+		builds.push_back(build);
+	}
 
-	return true;
+	buildingManager->addBuildings(builds);
 }
 
-bool SaveManager::loadBuildings()
+void SaveManager::writeChunk(std::vector<unsigned char>& file,
+	const char* id, const void* data, unsigned int size)
 {
-	std::fstream file;
-	file.open(SAVEFILE_NAME, std::ios::in | std::ios::binary);
+	const unsigned char* bytes = (const unsigned char*)data;
+
+	SaveChunkHeader header;
+	memcpy(header.id, id, 4);
+	header.flags = 0;
+	header.size = size;
+	header.storedSize = size;
+	header.checksum = checksum(bytes, size);
 
-	if (!file.is_open())
+	std::vector<unsigned char> packed;
+	if (m_compress)
 	{
-		printf("Couldn't open save file when loading buildings!!\n");
-		return false;
+		compress(bytes, size, packed);
+		// only worth keeping if it actually saved something
+		if (packed.size() < size)
+		{
+			header.flags |= SAVECHUNK_COMPRESSED;
+			header.storedSize = (unsigned int)packed.size();
+			bytes = packed.data();
+		}
 	}
 
-	// grab the number of buildings
-	int buildingCount = getBuildingCount(&file);
-	// grab the world size so we know how far into the file to read
-	int worldWidth, worldHeight;
-	getWorldSize(&worldWidth, &worldHeight, &file);
+	file.insert(file.end(), (const unsigned char*)&header,
+		(const unsigned char*)&header + sizeof(SaveChunkHeader));
+	file.insert(file.end(), bytes, bytes + header.storedSize);
+}
 
-	// seek past the header and the whole world
-	int buildingStart = m_headerSize + (worldWidth * worldHeight);
-	file.seekg(buildingStart);
+bool SaveManager::readChunk(const SaveChunkHeader& header,
+	const unsigned char* stored, std::vector<unsigned char>& data)
+{
+	data.resize(header.size);
 
-	printf("Loading %d buildings!\n", buildingCount);
+	if (header.flags & SAVECHUNK_COMPRESSED)
+	{
+		if (!decompress(stored, header.storedSize, data.data(), header.size))
+		{
+			printf("Couldn't decompress save chunk %.4s!\n", header.id);
+			return false;
+		}
+	}
+	else
+	{
+		if (header.storedSize != header.size)
+		{
+			printf("Save chunk %.4s is the wrong size!\n", header.id);
+			return false;
+		}
+		if (header.size > 0)
+			memcpy(data.data(), stored, header.size);
+	}
 
-	readBuildings(&file, buildingCount);
+	if (checksum(data.data(), header.size) != header.checksum)
+	{
+		printf("Save chunk %.4s is corrupted!\n", header.id);
+		return false;
+	}
 
 	return true;
 }
 
-bool SaveManager::loadTiles()
+void SaveManager::compress(const unsigned char* data, unsigned int size,
+	std::vector<unsigned char>& out)
 {
-	std::fstream file;
-	file.open(SAVEFILE_NAME, std::ios::in | std::ios::binary);
-
-	if (!file.is_open())
+	// each block starts with a control byte:
+	//   0-127:   copy the next control+1 bytes as they are
+	//   129-255: repeat the next byte 257-control times
+	out.clear();
+	unsigned int i = 0;
+	while (i < size)
 	{
-		printf("Couldn't open save file when loading tiles!!\n");
-		return false;
-	}
+		unsigned int run = 1;
+		while (i + run < size && run < 128 && data[i + run] == data[i])
+			run++;
 
-	// grab the world size
-	int worldWidth, worldHeight;
-	getWorldSize(&worldWidth, &worldHeight, &file);
+		if (run >= 3)
+		{
+			out.push_back((unsigned char)(257 - run));
+			out.push_back(data[i]);
+			i += run;
+			continue;
+		}
 
-	// skip to the start of tile data (just after header)
-	file.seekg(m_headerSize, std::ios::beg);
+		// copy bytes as they are until the next run worth encoding
+		unsigned int start = i;
+		while (i < size && i - start < 128)
+		{
+			if (i + 2 < size && data[i] == data[i + 1] && data[i] == data[i + 2])
+				break;
+			i++;
+		}
+		out.push_back((unsigned char)(i - start - 1));
+		out.insert(out.end(), data + start, data + i);
+	}
+}
 
-	// grab tiles!
-	readTiles(&file, worldWidth, worldHeight);
+bool SaveManager::decompress(const unsigned char* data, unsigned int size,
+	unsigned char* out, unsigned int outSize)
+{
+	unsigned int in = 0, written = 0;
+	while (in < size)
+	{
+		unsigned char control = data[in++];
+		if (control < 128)
+		{
+			unsigned int count = control + 1;
+			if (in + count > size || written + count > outSize)
+				return false;
+			memcpy(out + written, data + in, count);
+			in += count;
+			written += count;
+		}
+		else if (control > 128)
+		{
+			unsigned int count = 257 - control;
+			if (in >= size || written + count > outSize)
+				return false;
+			memset(out + written, data[in++], count);
+			written += count;
+		}
+	}
 
-	return true;
+	return written == outSize;
 }
+
+unsigned int SaveManager::checksum(const unsigned char* data,
+	unsigned int size)
+{
+	// Adler-32, summing in blocks small enough that they can't overflow
+	//   before being wrapped
+	const unsigned int mod = 65521;
+	unsigned int a = 1, b = 0;
+	while (size > 0)
+	{
+		unsigned int block = size < 5552 ? size : 5552;
+		size -= block;
+		while (block-- > 0)
+		{
+			a += *data++;
+			b += a;
+		}
+		a %= mod;
+		b %= mod;
+	}
+
+	return (b << 16) | a;
+}
\ No newline at end of file
@@ -1,12 +1,80 @@
 #pragma once
 
-#include <fstream>
+#include <string>
+#include <vector>
 
 // Forward declares
-class Game;
+class Simulation;
 
 #define SAVEFILE_NAME "city.wld"
 
+// first 4 bytes of every chunked save file
+#define SAVE_MAGIC "CWLD"
+// version written by saveData
+// older saves don't have a version, they're worked out from their size:
+//   0: world size, building count, zones, buildings
+//   1: money, world size, building count, zones, buildings
+#define SAVE_VERSION 2
+
+// flags stored with each chunk
+#define SAVECHUNK_COMPRESSED 0b00000001
+
+// chunk ids, as 4 characters
+#define SAVECHUNK_INFO "INFO"
+#define SAVECHUNK_ZONES "ZONE"
+#define SAVECHUNK_BUILDINGS "BLDG"
+
+/*
+	save format (version 2), all little endian:
+
+	SaveHeader
+	then for each chunk:
+		SaveChunkHeader
+		storedSize bytes of data, run-length encoded if compressed
+
+	INFO chunk: one SaveInfo
+	ZONE chunk: 1 byte zone per tile, in the same order as the TileGrid
+	BLDG chunk: one SaveBuildingRecord per building
+
+	unknown chunks are skipped, so more can be added without breaking
+	  older versions
+*/
+
+struct SaveHeader
+{
+	char			magic[4];
+	unsigned int	version;
+	unsigned int	chunkCount;
+};
+
+struct SaveChunkHeader
+{
+	char			id[4];
+	unsigned int	flags;
+	// how many bytes are in the file
+	unsigned int	storedSize;
+	// how many bytes there are once decompressed
+	unsigned int	size;
+	// Adler-32 of the decompressed data
+	unsigned int	checksum;
+};
+
+struct SaveInfo
+{
+	int money;
+	int worldWidth;
+	int worldHeight;
+	int buildingCount;
+};
+
+struct SaveBuildingRecord
+{
+	short	type;
+	short	padding;
+	int		x;
+	int		y;
+};
+
 class SaveManager
 {
 public:
@@ -14,9 +82,9 @@ public:
 	// (explicit because we don't want any implicit conversion)
 	//
 	// Param:
-	//			game: pointer to our Game so we can access everything we need
+	//			sim:  pointer to our Simulation so we can access everything
 	//------------------------------------------------------------------------
-	explicit SaveManager(Game* game);
+	explicit SaveManager(Simulation* sim);
 
 	//------------------------------------------------------------------------
 	// Loads all data from the save file
@@ -46,20 +114,84 @@ public:
 	// Loads only the tiles zones from the save file
 	//------------------------------------------------------------------------
 	bool loadTiles();
+
+	//------------------------------------------------------------------------
+	// Sets whether chunks are compressed when saving
+	// Chunks are only ever stored compressed if it makes them smaller
+	//
+	// Param:
+	//			compress: true to compress chunks
+	//------------------------------------------------------------------------
+	void setCompression(bool compress) { m_compress = compress; }
+	//------------------------------------------------------------------------
+	// Sets which file is saved to and loaded from
+	// Defaults to SAVEFILE_NAME
+	//
+	// Param:
+	//			fileName: path of the save file
+	//------------------------------------------------------------------------
+	void setFileName(const char* fileName) { m_fileName = fileName; }
+	//------------------------------------------------------------------------
+	// Sets whether loading says what it's loading
+	// Problems with the file are always printed
+	//
+	// Param:
+	//			quiet: true to not print anything when a load goes fine
+	//------------------------------------------------------------------------
+	void setQuiet(bool quiet) { m_quiet = quiet; }
 private:
-	Game* m_game;
+	// everything in a save file, unpacked
+	struct SaveData
+	{
+		SaveInfo						info;
+		std::vector<unsigned char>		zones;
+		std::vector<SaveBuildingRecord>	buildings;
+		bool							hasInfo;
+		bool							hasZones;
+		bool							hasBuildings;
+	};
+
+	Simulation* m_sim;
+
+	bool m_compress;
+	bool m_quiet;
+	std::string m_fileName;
+
+	// the whole file is read/written in one go, and everything else
+	//   works on memory
+	bool readFile(std::vector<unsigned char>& file);
+	bool writeFile(const std::vector<unsigned char>& file);
+
+	// turns a file into SaveData, handling old versions too
+	bool parseFile(const std::vector<unsigned char>& file, SaveData& save);
+	bool parseLegacyFile(const std::vector<unsigned char>& file, SaveData& save);
+	// turns SaveData into a file
+	void buildFile(const SaveData& save, std::vector<unsigned char>& file);
+	// reads the file and parses it, used by every load function
+	bool loadSaveData(SaveData& save, const char* what);
+
+	// whether or not a world size read from a file is usable
+	bool isWorldSizeValid(int width, int height) const;
 
-	// how many bytes the starting information takes up
-	// consisting of money, map size and building count
-	const int m_headerSize;
+	// copy between the Simulation and SaveData
+	void storeInfo(SaveData& save);
+	void storeTiles(SaveData& save);
+	void storeBuildings(SaveData& save);
+	bool applyTiles(const SaveData& save);
+	void applyBuildings(const SaveData& save);
 
-	// used in loadTiles and loadBuildings
-	void getWorldSize(int* width, int* height, std::fstream* openFile);
-	int getBuildingCount(std::fstream* openFile);
+	// adds a chunk to the end of a file, compressing it if worthwhile
+	void writeChunk(std::vector<unsigned char>& file, const char* id,
+		const void* data, unsigned int size);
+	// decompresses and checks a chunk
+	bool readChunk(const SaveChunkHeader& header, const unsigned char* stored,
+		std::vector<unsigned char>& data);
 
-	// functions to reduce duplicate code in load/save Buildings/Tiles
-	void readTiles(std::fstream* openFile, int worldWidth, int worldHeight);
-	void readBuildings(std::fstream* openFile, int buildingCount);
-	void writeTiles(std::fstream* openFile, int worldWidth, int worldHeight);
-	void writeBuildings(std::fstream* openFile);
+	// PackBits style run-length encoding, which suits zones well since
+	//   they come in big blocks
+	static void compress(const unsigned char* data, unsigned int size,
+		std::vector<unsigned char>& out);
+	static bool decompress(const unsigned char* data, unsigned int size,
+		unsigned char* out, unsigned int outSize);
+	static unsigned int checksum(const unsigned char* data, unsigned int size);
 };
\ No newline at end of file
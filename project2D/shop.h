@@ -5,7 +5,7 @@
 class Shop : public Building
 {
 public:
-	Shop(Game* game, int x, int y);
+	Shop(Simulation* sim, int x, int y);
 
 	void draw(aie::Renderer2D* renderer) override;
 };
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "simulation.h"
+
+#include "game.h"
+#include "darray.h"
+#include "tilegrid.h"
+#include "citystats.h"
+#include "roadmanager.h"
+#include "savemanager.h"
+#include "tilemanager.h"
+#include "imagemanager.h"
+#include "powermanager.h"
+#include "buildingindex.h"
+#include "buildingmanager.h"
+#include "pollutionmanager.h"
+
+Simulation::Simulation(Game* game, int worldWidth, int worldHeight)
+	: m_game(game)
+{
+	m_buildings = new BuildingList;
+	m_stats = new CityStats;
+	// start off with an empty world
+	m_tiles = new TileGrid;
+	m_tiles->setStats(m_stats);
+	m_tiles->resize(worldWidth, worldHeight);
+
+	// only bother loading textures if there's a window to draw them in
+	m_imageManager = new ImageManager(!isHeadless());
+	m_buildingManager = new BuildingManager(this, m_buildings);
+	m_roadManager = new RoadManager(this);
+	m_saveManager = new SaveManager(this);
+	m_tileManager = new TileManager(this, m_tiles);
+	m_powerManager = new PowerManager(this);
+	m_pollutionManager = new PollutionManager(this);
+	m_pollutionManager->resize(worldWidth, worldHeight);
+
+	m_mapStart = Vector2(1200, 800);
+
+	m_money = 2000;
+
+	setSeed(SIM_DEFAULT_SEED);
+
+	m_tickTimer = 0.0f;
+	m_tickCount = 0;
+}
+
+Simulation::~Simulation()
+{
+	m_buildingManager->clearBuildings();
+	delete m_buildingManager;
+	delete m_roadManager;
+	delete m_saveManager;
+	delete m_tileManager;
+	delete m_powerManager;
+	delete m_pollutionManager;
+	delete m_imageManager;
+
+	delete m_buildings;
+	delete m_tiles;
+	delete m_stats;
+}
+
+void Simulation::setSeed(const unsigned int seed)
+{
+	m_seed = seed;
+	for (int i = 0; i < RANDOMSTREAM_COUNT; ++i)
+		m_random[i].seed(seed, i);
+}
+
+void Simulation::newWorld(int width, int height)
+{
+	// buildings need to come off the old tiles before they're thrown away
+	m_buildingManager->clearBuildings();
+	m_tileManager->clearTiles(width, height);
+	// and everything else that's laid out over the world needs resizing
+	m_roadManager->clearRoads();
+	m_buildingManager->getBuildingIndex()->resize(width, height);
+	m_pollutionManager->resize(width, height);
+}
+
+int Simulation::getWorldWidth() const
+{
+	return m_tiles->getWidth();
+}
+
+int Simulation::getWorldHeight() const
+{
+	return m_tiles->getHeight();
+}
+
+void Simulation::update(float delta)
+{
+	m_tickTimer += delta;
+
+	const float tickTime = getTickTime();
+	int ticksRun = 0;
+	while (m_tickTimer >= tickTime)
+	{
+		// we're too far behind to catch up, so forget about it
+		if (ticksRun >= SIM_MAX_CATCHUP_TICKS)
+		{
+			m_tickTimer = 0.0f;
+			break;
+		}
+
+		tick();
+		m_tickTimer -= tickTime;
+		ticksRun++;
+	}
+}
+
+void Simulation::tick()
+{
+	m_buildingManager->updateBuildings(getTickTime());
+	if (m_tickCount % POLLUTION_TICKS_PER_STEP == 0)
+		m_pollutionManager->step();
+	m_tickCount++;
+}
+
+// -------------------------------
+//   things passed on to the game:
+
+void Simulation::spawnSmokeParticle(const Vector2& pos)
+{
+	if (m_game)
+		m_game->spawnSmokeParticle(pos);
+}
+
+void Simulation::spawnPollutionParticle(const Vector2& pos)
+{
+	if (m_game)
+		m_game->spawnPollutionParticle(pos);
+}
+
+void Simulation::spawnTextParticle(const Vector2& pos, std::string text)
+{
+	if (m_game)
+		m_game->spawnTextParticle(pos, text);
+}
+
+void Simulation::doScreenShake(float amt)
+{
+	if (m_game)
+		m_game->doScreenShake(amt);
+}
+
+Vector2 Simulation::getMouseWorldPosition()
+{
+	if (m_game)
+		return m_game->getMouseWorldPosition();
+
+	// nobody's looking, so pretend the mouse is very far away
+	return Vector2(-100000.0f, -100000.0f);
+}
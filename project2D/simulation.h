@@ -0,0 +1,209 @@
+#pragma once
+
+#include <string>
+
+#include "random.h"
+#include "vector2.h"
+
+#define TILE_WIDTH 132
+#define TILE_HEIGHT 99
+
+// size of a new world when nothing else is asked for
+#define DEFAULT_WORLD_WIDTH 64
+#define DEFAULT_WORLD_HEIGHT 64
+// the biggest world we'll accept from a save, so a broken header can't
+//   make us allocate something huge
+#define MAX_WORLD_SIZE 4096
+
+// how many times a second the simulation ticks
+#define SIM_TICK_RATE 60
+// how many ticks update is allowed to catch up on at once before it gives
+//   up and drops the rest, so one long frame doesn't snowball
+#define SIM_MAX_CATCHUP_TICKS 20
+// what the random streams are seeded with unless setSeed is called, so
+//   headless runs and benchmarks come out the same every time
+#define SIM_DEFAULT_SEED 1
+
+template <class T>
+class DArray;
+
+class Game;
+class Building;
+class TileGrid;
+class CityStats;
+
+class ImageManager;
+class SaveManager;
+
+class BuildingManager;
+class RoadManager;
+class TileManager;
+class PowerManager;
+class PollutionManager;
+
+// typedef these so it's easier to type
+typedef DArray<Building*> BuildingList;
+
+// the Simulation owns the world - tiles, buildings, money and all the
+//   managers that look after them - and steps it forwards at a fixed rate
+// it doesn't need a window, so it can run on its own (headless) or be
+//   driven and drawn by a Game
+class Simulation
+{
+public:
+	//------------------------------------------------------------------------
+	// (explicit because we don't want any implicit conversion)
+	//
+	// Param:
+	//			game:        the Game showing this simulation, or nullptr to
+	//						 run headless with no window, textures or particles
+	//			worldWidth:  how many tiles wide the starting world is
+	//			worldHeight: how many tiles tall the starting world is
+	//------------------------------------------------------------------------
+	explicit Simulation(Game* game = nullptr,
+		int worldWidth = DEFAULT_WORLD_WIDTH,
+		int worldHeight = DEFAULT_WORLD_HEIGHT);
+	~Simulation();
+
+	// we don't expect Simulation to be copied/moved
+	Simulation(const Simulation& sim) = default;
+	Simulation(Simulation&& sim) = default;
+	Simulation& operator=(Simulation& sim) = default;
+	Simulation& operator=(Simulation&& sim) = default;
+
+	//------------------------------------------------------------------------
+	// Runs however many fixed ticks fit into the time that has passed
+	// Leftover time is saved for the next call
+	//
+	// Param:
+	//			delta: time in seconds since the last update
+	//------------------------------------------------------------------------
+	void update(float delta);
+	//------------------------------------------------------------------------
+	// Steps the simulation forward by exactly one tick
+	// Can be called in a loop to fast-forward without a window
+	//------------------------------------------------------------------------
+	void tick();
+	//------------------------------------------------------------------------
+	// Gets how long a single tick is in seconds
+	//
+	// Return:
+	//			length of a tick in seconds
+	//------------------------------------------------------------------------
+	float getTickTime() const { return 1.0f / SIM_TICK_RATE; }
+	//------------------------------------------------------------------------
+	// Gets how many ticks have been run since the simulation was created
+	//
+	// Return:
+	//			the number of ticks run
+	//------------------------------------------------------------------------
+	unsigned int getTickCount() const { return m_tickCount; }
+
+	//------------------------------------------------------------------------
+	// Throws away every building, road and zone and starts again with an
+	//   empty world
+	//
+	// Param:
+	//			width:  how many tiles wide the new world is
+	//			height: how many tiles tall the new world is
+	//------------------------------------------------------------------------
+	void newWorld(int width, int height);
+	// size of the world in tiles
+	int getWorldWidth() const;
+	int getWorldHeight() const;
+
+	Vector2& getMapStart() { return m_mapStart; }
+	//------------------------------------------------------------------------
+	// Gets the grid holding every tile's zone, power, pollution and building
+	//
+	// Return:
+	//			pointer to the TileGrid
+	//------------------------------------------------------------------------
+	TileGrid* getTiles() { return m_tiles; }
+	//------------------------------------------------------------------------
+	// Gets the totals for the whole city, like building counts and demand
+	//
+	// Return:
+	//			pointer to the CityStats
+	//------------------------------------------------------------------------
+	CityStats* getStats() { return m_stats; }
+
+	//------------------------------------------------------------------------
+	// Seeds every random stream, so the same seed and the same actions
+	//   always play out the same way
+	//
+	// Param:
+	//			seed: the seed to start every stream from
+	//------------------------------------------------------------------------
+	void setSeed(unsigned int seed);
+	unsigned int getSeed() const { return m_seed; }
+	//------------------------------------------------------------------------
+	// Gets one of the random number streams
+	// A stream should only be used on one thread at a time, jobs should make
+	//   their own Random from a number taken from a stream instead
+	//
+	// Param:
+	//			stream: which part of the game the numbers are for
+	// Return:
+	//			the generator for that stream
+	//------------------------------------------------------------------------
+	Random& getRandom(RandomStream stream) { return m_random[stream]; }
+
+	// money-related functions
+	int  getMoney() const { return m_money; }
+	void setMoney(int money) { m_money = money; }
+	void addMoney(int money) { m_money += money; }
+
+	// getters for all of the managers
+	ImageManager*		getImageManager() { return m_imageManager; }
+	BuildingManager*	getBuildingManager() { return m_buildingManager; }
+	RoadManager*		getRoadManager() { return m_roadManager; }
+	SaveManager*		getSaveManager() { return m_saveManager; }
+	TileManager*		getTileManager() { return m_tileManager; }
+	PowerManager*		getPowerManager() { return m_powerManager; }
+	PollutionManager*	getPollutionManager() { return m_pollutionManager; }
+
+	//------------------------------------------------------------------------
+	// Gets the Game showing this simulation
+	//
+	// Return:
+	//			pointer to the Game, nullptr if running headless
+	//------------------------------------------------------------------------
+	Game* getGame() { return m_game; }
+	bool  isHeadless() const { return m_game == nullptr; }
+
+	// things that only matter when there's something to see
+	// these are passed on to the Game and do nothing when headless
+	void	spawnSmokeParticle(const Vector2& pos);
+	void	spawnPollutionParticle(const Vector2& pos);
+	void	spawnTextParticle(const Vector2& pos, std::string text);
+	void	doScreenShake(float amt);
+	Vector2 getMouseWorldPosition();
+private:
+	Game*				m_game;
+
+	// map/world-related stuff
+	Vector2				m_mapStart;
+	TileGrid*			m_tiles;
+	BuildingList*		m_buildings;
+	CityStats*			m_stats;
+
+	ImageManager*		m_imageManager;
+	BuildingManager*	m_buildingManager;
+	RoadManager*		m_roadManager;
+	SaveManager*		m_saveManager;
+	TileManager*		m_tileManager;
+	PowerManager*		m_powerManager;
+	PollutionManager*	m_pollutionManager;
+
+	// gameplay variables
+	int					m_money;
+
+	// every stream of random numbers, all started from m_seed
+	unsigned int		m_seed;
+	Random				m_random[RANDOMSTREAM_COUNT];
+
+	// time left over from the last update that didn't fill a whole tick
+	float				m_tickTimer;
+	unsigned int		m_tickCount;
+};
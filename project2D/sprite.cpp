@@ -0,0 +1,11 @@
+#include "sprite.h"
+
+void Sprite::draw(aie::Renderer2D* renderer, float x, float y,
+	float rotation, float depth, float xOrigin, float yOrigin) const
+{
+	renderer->setUVRect(uvX, uvY, uvW, uvH);
+	renderer->drawSprite(texture, x, y, (float)width, (float)height,
+		rotation, depth, xOrigin, yOrigin);
+	// put it back so boxes and plain textures still use the whole texture
+	renderer->setUVRect(0.0f, 0.0f, 1.0f, 1.0f);
+}
\ No newline at end of file
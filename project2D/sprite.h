@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Texture.h"
+#include "Renderer2D.h"
+
+// a picture to draw, which is either a whole texture or a rectangle of an
+//   atlas page that lots of pictures share
+// sharing a texture means the renderer doesn't have to stop and flush
+//   every time it switches between pictures
+struct Sprite
+{
+	// the texture the picture is in
+	aie::Texture*	texture;
+	// where the picture is in the texture, from 0 to 1
+	float			uvX, uvY, uvW, uvH;
+	// size of the picture in pixels
+	unsigned int	width, height;
+
+	unsigned int getWidth() const { return width; }
+	unsigned int getHeight() const { return height; }
+
+	//------------------------------------------------------------------------
+	// Draws the picture at its own size
+	// Works the same as Renderer2D::drawSprite with no width or height
+	//
+	// Param:
+	//			renderer: a pointer to the Renderer2D used to draw everything
+	//			x:        x position to draw at
+	//			y:        y position to draw at
+	//			rotation: rotation in radians
+	//			depth:    depth to draw at
+	//			xOrigin:  where x is across the picture, from 0 to 1
+	//			yOrigin:  where y is up the picture, from 0 to 1
+	//------------------------------------------------------------------------
+	void draw(aie::Renderer2D* renderer, float x, float y,
+		float rotation = 0.0f, float depth = 0.0f,
+		float xOrigin = 0.5f, float yOrigin = 0.5f) const;
+};
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "textureatlas.h"
+
+#include <cstdio>
+#include <algorithm>
+
+#include "JobSystem.h"
+#include "gl_core_4_4.h"
+
+TextureAtlas::TextureAtlas()
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+	for (auto page : m_pages)
+		delete page;
+}
+
+void TextureAtlas::pack(const std::vector<std::string>& names,
+	const char* fileTemplate, std::map<std::string, Sprite>& sprites)
+{
+	const int maxSize = ATLAS_PAGE_SIZE - ATLAS_PADDING * 2;
+
+	// load everything first so we know how big it all is
+	// decoding is most of the time spent starting up, and each picture is
+	//   decoded on its own, so they're spread across the threads
+	std::vector<PackImage> loaded(names.size());
+	aie::JobSystem::getInstance()->parallelFor((int)names.size(), 1,
+		[&](int start, int end)
+	{
+		for (int i = start; i < end; ++i)
+		{
+			const int fileNameSize = 512;
+			char fileName[fileNameSize];
+			snprintf(fileName, fileNameSize, fileTemplate, names[i].c_str());
+
+			PackImage& image = loaded[i];
+			image.name = names[i];
+			image.pixels = aie::Texture::loadPixels(fileName, &image.width,
+				&image.height, &image.format);
+			image.page = 0;
+			image.x = 0;
+			image.y = 0;
+		}
+	});
+
+	std::vector<PackImage> images;
+	for (auto& image : loaded)
+	{
+		if (image.pixels == nullptr || (int)image.width > maxSize
+			|| (int)image.height > maxSize)
+		{
+			printf("Texture named %s can't go in the atlas!\n",
+				image.name.c_str());
+			if (image.pixels)
+				aie::Texture::freePixels(image.pixels);
+			continue;
+		}
+		images.push_back(image);
+	}
+
+	if (images.empty())
+		return;
+
+	// tallest first, so each shelf wastes as little height as possible
+	std::sort(images.begin(), images.end(),
+		[](const PackImage& a, const PackImage& b)
+	{
+		return a.height > b.height;
+	});
+
+	// fill up shelves left to right, top to bottom, starting a new page
+	//   when one runs out of room
+	int firstPage = (int)m_pages.size();
+	int page = firstPage;
+	int shelfX = 0, shelfY = 0, shelfHeight = 0;
+	for (auto& image : images)
+	{
+		int cellWidth = image.width + ATLAS_PADDING * 2;
+		int cellHeight = image.height + ATLAS_PADDING * 2;
+
+		if (shelfX + cellWidth > ATLAS_PAGE_SIZE)
+		{
+			shelfX = 0;
+			shelfY += shelfHeight;
+			shelfHeight = 0;
+		}
+		if (shelfY + cellHeight > ATLAS_PAGE_SIZE)
+		{
+			page++;
+			shelfX = 0;
+			shelfY = 0;
+			shelfHeight = 0;
+		}
+
+		image.page = page;
+		image.x = shelfX + ATLAS_PADDING;
+		image.y = shelfY + ATLAS_PADDING;
+
+		shelfX += cellWidth;
+		shelfHeight = std::max(shelfHeight, cellHeight);
+	}
+
+	// build the pages
+	std::vector<unsigned char> pagePixels;
+	for (int p = firstPage; p <= page; ++p)
+	{
+		pagePixels.assign(ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4, 0);
+		for (auto& image : images)
+		{
+			if (image.page == p)
+				copyToPage(pagePixels.data(), image);
+		}
+		m_pages.push_back(createPage(pagePixels.data()));
+	}
+
+	// and tell everyone where their pictures ended up
+	const float pageSize = (float)ATLAS_PAGE_SIZE;
+	for (auto& image : images)
+	{
+		Sprite sprite;
+		sprite.texture = m_pages[image.page];
+		sprite.width = image.width;
+		sprite.height = image.height;
+		sprite.uvX = image.x / pageSize;
+		sprite.uvY = image.y / pageSize;
+		sprite.uvW = sprite.width / pageSize;
+		sprite.uvH = sprite.height / pageSize;
+		sprites[image.name] = sprite;
+
+		// the pixels are in the page now, so the original can go
+		aie::Texture::freePixels(image.pixels);
+	}
+
+	printf("Packed %d textures into %d atlas pages\n", (int)images.size(),
+		page - firstPage + 1);
+}
+
+void TextureAtlas::copyToPage(unsigned char* pagePixels,
+	const PackImage& image) const
+{
+	const int width = image.width;
+	const int height = image.height;
+	// the format is also how many bytes each pixel takes
+	const int channels = image.format;
+	const unsigned char* pixels = image.pixels;
+
+	for (int y = -ATLAS_PADDING; y < height + ATLAS_PADDING; ++y)
+	{
+		// the padding repeats the closest edge pixel
+		int srcY = std::min(std::max(y, 0), height - 1);
+		for (int x = -ATLAS_PADDING; x < width + ATLAS_PADDING; ++x)
+		{
+			int srcX = std::min(std::max(x, 0), width - 1);
+			const unsigned char* src = pixels + (srcY * width + srcX) * channels;
+			unsigned char* dst = pagePixels
+				+ ((image.y + y) * ATLAS_PAGE_SIZE + (image.x + x)) * 4;
+
+			switch (channels)
+			{
+			case aie::Texture::RED:
+				dst[0] = dst[1] = dst[2] = src[0];
+				dst[3] = 255;
+				break;
+			case aie::Texture::RG:
+				dst[0] = dst[1] = dst[2] = src[0];
+				dst[3] = src[1];
+				break;
+			case aie::Texture::RGB:
+				dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2];
+				dst[3] = 255;
+				break;
+			default:
+				dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2];
+				dst[3] = src[3];
+				break;
+			}
+		}
+	}
+}
+
+aie::Texture* TextureAtlas::createPage(unsigned char* pagePixels) const
+{
+	auto page = new aie::Texture(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE,
+		aie::Texture::RGBA, pagePixels);
+
+	// textures made from pixels aren't smoothed, but loaded ones are, so
+	//   match them
+	glBindTexture(GL_TEXTURE_2D, page->getHandle());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	return page;
+}
\ No newline at end of file
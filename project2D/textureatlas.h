@@ -0,0 +1,70 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Texture.h"
+
+#include "sprite.h"
+
+// how many pixels wide and tall each atlas page is
+#define ATLAS_PAGE_SIZE 1024
+// empty pixels left around each picture, filled with copies of its edges
+//   so smoothing doesn't pull in the picture next to it
+#define ATLAS_PADDING 2
+
+// packs lots of small pictures into a few big textures (pages)
+class TextureAtlas
+{
+public:
+	TextureAtlas();
+	~TextureAtlas();
+
+	// we don't expect TextureAtlas to be copied/moved
+	TextureAtlas(const TextureAtlas& ta) = default;
+	TextureAtlas(TextureAtlas&& ta) = default;
+	TextureAtlas& operator=(TextureAtlas& ta) = default;
+	TextureAtlas& operator=(TextureAtlas&& ta) = default;
+
+	//------------------------------------------------------------------------
+	// Loads a list of pictures and packs them into pages
+	// The pictures are decoded across every thread in the JobSystem
+	// Pictures which couldn't be loaded or are too big for a page are left
+	//   out, so they can be loaded on their own instead
+	//
+	// Param:
+	//			names:        names of the pictures, as given to ImageManager
+	//			fileTemplate: printf format turning a name into a file name
+	//			sprites:      where the packed pictures are stored, by name
+	//------------------------------------------------------------------------
+	void pack(const std::vector<std::string>& names, const char* fileTemplate,
+		std::map<std::string, Sprite>& sprites);
+
+	//------------------------------------------------------------------------
+	// Gets how many pages the pictures were packed into
+	//
+	// Return:
+	//			the number of pages
+	//------------------------------------------------------------------------
+	int getPageCount() const { return (int)m_pages.size(); }
+private:
+	// a picture waiting to be packed
+	struct PackImage
+	{
+		std::string		name;
+		// decoded by aie::Texture::loadPixels, nullptr if it couldn't be
+		unsigned char*	pixels;
+		unsigned int	width, height;
+		aie::Texture::Format format;
+		int				page;
+		int				x, y;
+	};
+
+	std::vector<aie::Texture*> m_pages;
+
+	// copies a picture into a page's pixels, along with its padding
+	void copyToPage(unsigned char* pagePixels, const PackImage& image) const;
+	// makes a page texture out of pixels
+	aie::Texture* createPage(unsigned char* pagePixels) const;
+};
\ No newline at end of file
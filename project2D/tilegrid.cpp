@@ -0,0 +1,150 @@
+#include "tilegrid.h"
+
+#include <cstring>
+
+#include "citystats.h"
+
+TileGrid::TileGrid()
+{
+	m_width = 0;
+	m_height = 0;
+
+	m_zones = nullptr;
+	m_power = nullptr;
+	m_pollution = nullptr;
+	m_buildings = nullptr;
+
+	m_stats = nullptr;
+
+	m_chunkRevisions = nullptr;
+	m_buildingRevisions = nullptr;
+	m_chunksWide = 0;
+	m_chunksHigh = 0;
+	m_lastRevision = 0;
+}
+
+TileGrid::~TileGrid()
+{
+	delete[] m_zones;
+	delete[] m_power;
+	delete[] m_pollution;
+	delete[] m_buildings;
+	delete[] m_chunkRevisions;
+	delete[] m_buildingRevisions;
+}
+
+// deletes all the arrays and reallocates them at the new size
+void TileGrid::resize(int width, int height)
+{
+	delete[] m_zones;
+	delete[] m_power;
+	delete[] m_pollution;
+	delete[] m_buildings;
+	delete[] m_chunkRevisions;
+	delete[] m_buildingRevisions;
+
+	m_width = width;
+	m_height = height;
+	m_chunksWide = (width + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+	m_chunksHigh = (height + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+
+	int count = getTileCount();
+	m_zones = new unsigned char[count];
+	m_power = new unsigned short[count];
+	m_pollution = new float[count];
+	m_buildings = new Building*[count];
+	m_chunkRevisions = new unsigned int[m_chunksWide * m_chunksHigh];
+	m_buildingRevisions = new unsigned int[m_chunksWide * m_chunksHigh];
+
+	clear();
+}
+
+void TileGrid::setStats(CityStats* stats)
+{
+	m_stats = stats;
+
+	// catch the stats up with the tiles it's missed
+	if (m_stats && m_zones)
+		m_stats->countZones(m_zones, getTileCount());
+}
+
+void TileGrid::clear()
+{
+	int count = getTileCount();
+	// ZONETYPE_NONE is 0, so zeroing is the same as an empty tile
+	memset(m_zones, 0, count * sizeof(unsigned char));
+	if (m_stats)
+		m_stats->countZones(m_zones, count);
+	changeAllChunks(m_chunkRevisions);
+	memset(m_pollution, 0, count * sizeof(float));
+	clearBuildings();
+	clearPower();
+}
+
+void TileGrid::setZoneType(int x, int y, ZoneType type)
+{
+	unsigned char& zone = m_zones[getIndex(x, y)];
+	if (zone == type)
+		return;
+
+	if (m_stats)
+		m_stats->changeZone((ZoneType)zone, type);
+	zone = (unsigned char)type;
+
+	m_chunkRevisions[getChunkIndex(x, y)] = ++m_lastRevision;
+}
+
+void TileGrid::setZoneData(const unsigned char* zones)
+{
+	int count = getTileCount();
+	memcpy(m_zones, zones, count * sizeof(unsigned char));
+	if (m_stats)
+		m_stats->countZones(m_zones, count);
+	changeAllChunks(m_chunkRevisions);
+}
+
+void TileGrid::changeAllChunks(unsigned int* revisions)
+{
+	// one revision for all of them is enough, since it's still new
+	++m_lastRevision;
+	for (int i = 0; i < m_chunksWide * m_chunksHigh; ++i)
+		revisions[i] = m_lastRevision;
+}
+
+void TileGrid::addPower(int x, int y)
+{
+	unsigned short& power = m_power[getIndex(x, y)];
+	// only the first source makes a difference to the powered area
+	if (power++ == 0 && m_stats)
+		m_stats->changePoweredArea(1);
+}
+
+void TileGrid::removePower(int x, int y)
+{
+	unsigned short& power = m_power[getIndex(x, y)];
+	if (power > 0)
+	{
+		power--;
+		if (power == 0 && m_stats)
+			m_stats->changePoweredArea(-1);
+	}
+}
+
+void TileGrid::setBuilding(int x, int y, Building* b)
+{
+	m_buildings[getIndex(x, y)] = b;
+	m_buildingRevisions[getChunkIndex(x, y)] = ++m_lastRevision;
+}
+
+void TileGrid::clearBuildings()
+{
+	memset(m_buildings, 0, getTileCount() * sizeof(Building*));
+	changeAllChunks(m_buildingRevisions);
+}
+
+void TileGrid::clearPower()
+{
+	memset(m_power, 0, getTileCount() * sizeof(unsigned short));
+	if (m_stats)
+		m_stats->clearPoweredArea();
+}
\ No newline at end of file
@@ -0,0 +1,228 @@
+#pragma once
+
+// how many tiles along each side of the chunks the grid keeps track of
+//   zone and building changes in
+#define TILE_CHUNK_SIZE 16
+
+// Forward declares
+class Building;
+class CityStats;
+
+// Enum for which zone a tile is
+enum ZoneType
+{
+	ZONETYPE_NONE = 0,
+	ZONETYPE_RESIDENTIAL,
+	ZONETYPE_COMMERCIAL,
+	ZONETYPE_INDUSTRIAL,
+
+	ZONETYPE_COUNT // the total number of zones
+};
+
+// holds everything we know about the tiles in the world
+// each value is kept in its own flat array instead of in a Tile object, so
+//   going over every tile for one value walks straight through memory
+// arrays are row-major, so the tile at (x, y) is at index y * width + x
+class TileGrid
+{
+public:
+	TileGrid();
+	~TileGrid();
+
+	// we don't expect TileGrid to be copied/moved
+	TileGrid(const TileGrid& tg) = default;
+	TileGrid(TileGrid&& tg) = default;
+	TileGrid& operator=(TileGrid& tg) = default;
+	TileGrid& operator=(TileGrid&& tg) = default;
+
+	//------------------------------------------------------------------------
+	// Throws away all the tiles and makes a new set of empty ones
+	//
+	// Param:
+	//			width:  how many tiles wide the grid should be
+	//			height: how many tiles tall the grid should be
+	//------------------------------------------------------------------------
+	void resize(int width, int height);
+	//------------------------------------------------------------------------
+	// Sets every tile back to empty without changing the size of the grid
+	//------------------------------------------------------------------------
+	void clear();
+
+	// size of the grid
+	int getWidth() const { return m_width; }
+	int getHeight() const { return m_height; }
+	//------------------------------------------------------------------------
+	// Gets how many tiles are in the grid
+	//
+	// Return:
+	//			width * height
+	//------------------------------------------------------------------------
+	int getTileCount() const { return m_width * m_height; }
+
+	//------------------------------------------------------------------------
+	// Sets the CityStats to tell whenever a tile's zone or power changes
+	//
+	// Param:
+	//			stats: the stats to keep up to date, or nullptr for none
+	//------------------------------------------------------------------------
+	void setStats(CityStats* stats);
+
+	//------------------------------------------------------------------------
+	// Gets where a tile's values are stored in the arrays
+	// Doesn't check bounds, so make sure the indices are valid first
+	//
+	// Param:
+	//			x: x index of the tile
+	//			y: y index of the tile
+	// Return:
+	//			the index of the tile in the arrays
+	//------------------------------------------------------------------------
+	int getIndex(int x, int y) const { return y * m_width + x; }
+	//------------------------------------------------------------------------
+	// Checks if an index is within the bounds of the grid
+	//
+	// Param:
+	//			x: x index to check
+	//			y: y index to check
+	// Return:
+	//			whether or not the tile exists
+	//------------------------------------------------------------------------
+	bool isInBounds(int x, int y) const
+	{
+		return x >= 0 && y >= 0 && x < m_width && y < m_height;
+	}
+
+	// zone types
+	ZoneType getZoneType(int x, int y) const
+	{
+		return (ZoneType)m_zones[getIndex(x, y)];
+	}
+	void setZoneType(int x, int y, ZoneType type);
+	//------------------------------------------------------------------------
+	// Gets the zone of every tile, one byte per tile, for going over all of
+	//   them at once
+	//
+	// Return:
+	//			pointer to the first tile's ZoneType
+	//------------------------------------------------------------------------
+	const unsigned char* getZoneData() const { return m_zones; }
+	//------------------------------------------------------------------------
+	// Replaces the zone of every tile at once, such as when loading
+	//
+	// Param:
+	//			zones: one ZoneType byte per tile, in the same layout as
+	//			       getZoneData
+	//------------------------------------------------------------------------
+	void setZoneData(const unsigned char* zones);
+	//------------------------------------------------------------------------
+	// Gets a number which changes whenever a zone in a chunk changes, so
+	//   anything built from the zones knows when to build it again
+	// Never repeats, even if the grid is resized
+	//
+	// Param:
+	//			chunkX: x index of the chunk, in TILE_CHUNK_SIZE tiles
+	//			chunkY: y index of the chunk, in TILE_CHUNK_SIZE tiles
+	// Return:
+	//			the chunk's revision
+	//------------------------------------------------------------------------
+	unsigned int getChunkRevision(int chunkX, int chunkY) const
+	{
+		return m_chunkRevisions[chunkY * m_chunksWide + chunkX];
+	}
+	//------------------------------------------------------------------------
+	// The same as getChunkRevision, but changes whenever a building is put
+	//   on or taken off a tile in the chunk instead
+	// Revisions from both come from the same counter, so the newer of
+	//   the two is always the larger one
+	//
+	// Param:
+	//			chunkX: x index of the chunk, in TILE_CHUNK_SIZE tiles
+	//			chunkY: y index of the chunk, in TILE_CHUNK_SIZE tiles
+	// Return:
+	//			the chunk's building revision
+	//------------------------------------------------------------------------
+	unsigned int getChunkBuildingRevision(int chunkX, int chunkY) const
+	{
+		return m_buildingRevisions[chunkY * m_chunksWide + chunkX];
+	}
+	// how many chunks the grid is split into, rounded up
+	int getChunksWide() const { return m_chunksWide; }
+	int getChunksHigh() const { return m_chunksHigh; }
+
+	//------------------------------------------------------------------------
+	// Gets whether or not the tile is powered
+	//
+	// Param:
+	//			x: x index of the tile
+	//			y: y index of the tile
+	// Return:
+	//			whether or not the tile has power
+	//------------------------------------------------------------------------
+	bool hasPower(int x, int y) const { return m_power[getIndex(x, y)] > 0; }
+	//------------------------------------------------------------------------
+	// Adds a powered building to the list of things powering a tile
+	// Called by the PowerManager when a building spreads power there
+	//------------------------------------------------------------------------
+	void addPower(int x, int y);
+	//------------------------------------------------------------------------
+	// Takes away one of the buildings powering a tile
+	// The tile stays powered until every source is taken away
+	//------------------------------------------------------------------------
+	void removePower(int x, int y);
+	//------------------------------------------------------------------------
+	// Takes the power away from every tile at once
+	//------------------------------------------------------------------------
+	void clearPower();
+
+	// pollution, caused by nearby factories and spread by the
+	//   PollutionManager
+	float getPollution(int x, int y) const
+	{
+		return m_pollution[getIndex(x, y)];
+	}
+	//------------------------------------------------------------------------
+	// Gets the pollution of every tile, for going over all of them at once
+	//
+	// Return:
+	//			pointer to the first tile's pollution
+	//------------------------------------------------------------------------
+	float* getPollutionData() { return m_pollution; }
+
+	// the building on each tile, or nullptr if there isn't one
+	Building* getBuilding(int x, int y) const
+	{
+		return m_buildings[getIndex(x, y)];
+	}
+	void setBuilding(int x, int y, Building* b);
+	//------------------------------------------------------------------------
+	// Forgets about the buildings on every tile at once
+	//------------------------------------------------------------------------
+	void clearBuildings();
+private:
+	int				m_width, m_height;
+
+	// one ZoneType per tile, as bytes to keep the array small
+	unsigned char*	m_zones;
+	// how many powered buildings are spreading power to each tile
+	unsigned short*	m_power;
+	float*			m_pollution;
+	Building**		m_buildings;
+
+	// told whenever a tile's zone or power changes
+	CityStats*		m_stats;
+
+	// the zone and building revisions of every chunk, and the last one
+	//   given out
+	unsigned int*	m_chunkRevisions;
+	unsigned int*	m_buildingRevisions;
+	int				m_chunksWide, m_chunksHigh;
+	unsigned int	m_lastRevision;
+
+	// marks every chunk's zones or buildings as changed
+	void changeAllChunks(unsigned int* revisions);
+	// works out which chunk a tile is in
+	int getChunkIndex(int x, int y) const
+	{
+		return (y / TILE_CHUNK_SIZE) * m_chunksWide + (x / TILE_CHUNK_SIZE);
+	}
+};
\ No newline at end of file
@@ -1,14 +1,56 @@
 #include "tilemanager.h"
 
+#include <cmath>
+#include <algorithm>
+
 #include "Input.h"
 
 #include "game.h"
-#include "tile.h"
+#include "tilegrid.h"
+#include "simulation.h"
+#include "roadmanager.h"
 #include "imagemanager.h"
 
-TileManager::TileManager(Game* game, Tile**** tiles)
-	: m_game(game), m_tiles(tiles)
+const unsigned int TileManager::m_zoneTintColours[ZONETYPE_COUNT] =
+{
+	0xffffffff, // ZONETYPE_NONE
+	0x88ff88ff, // ZONETYPE_RESIDENTIAL
+	0x4488ffff, // ZONETYPE_COMMERCIAL
+	0xffbb00ff, // ZONETYPE_INDUSTRIAL
+};
+
+const unsigned int TileManager::m_buildingMarkerColours[BUILDINGTYPE_COUNT] =
+{
+	0x00000000, // BUILDINGTYPE_NONE
+	0x757575ff, // BUILDINGTYPE_POWERPLANT
+	0x8b5a2bff, // BUILDINGTYPE_POWERPOLE
+	0x3f4244ff, // BUILDINGTYPE_ROAD
+	0xb04a4aff, // BUILDINGTYPE_HOUSE
+	0x3f8f9fff, // BUILDINGTYPE_SHOP
+	0xc8a040ff, // BUILDINGTYPE_FACTORY
+};
+
+// chunks at full detail line up with the TileGrid's so they can use its
+//   revisions directly
+const int TileManager::m_lodChunkSizes[LODLEVEL_COUNT] =
+{
+	TILE_CHUNK_SIZE,	 // LODLEVEL_FULL
+	TILE_CHUNK_SIZE,	 // LODLEVEL_FLAT
+	TILE_CHUNK_SIZE * 4, // LODLEVEL_OVERVIEW
+};
+
+const int TileManager::m_lodBlockSizes[LODLEVEL_COUNT] =
 {
+	1, // LODLEVEL_FULL
+	1, // LODLEVEL_FLAT
+	2, // LODLEVEL_OVERVIEW
+};
+
+TileManager::TileManager(Simulation* sim, TileGrid* tiles)
+	: m_sim(sim), m_tiles(tiles)
+{
+	m_tileSprite = m_sim->getImageManager()->getSprite(SPRITE_GRASS);
+
 	m_selectedType = ZONETYPE_NONE;
 	m_dragging = false;
 
@@ -16,6 +58,14 @@ TileManager::TileManager(Game* game, Tile**** tiles)
 	m_dragStartY = 0;
 	m_dragEndX = 0;
 	m_dragEndY = 0;
+
+	m_chunkGridWidth = 0;
+	m_chunkGridHeight = 0;
+}
+
+TileManager::~TileManager()
+{
+	clearChunks();
 }
 
 void TileManager::updateZoneEditing()
@@ -24,14 +74,14 @@ void TileManager::updateZoneEditing()
 	// Z to toggle mode
 	if (input->wasKeyPressed(aie::INPUT_KEY_Z))
 	{
-		m_game->setPlaceMode(PLACEMODE_NONE);
+		m_sim->getGame()->setPlaceMode(PLACEMODE_NONE);
 		return;
 	}
 
 	// zone creation
 	if (!m_dragging
 		&& input->wasMouseButtonPressed(aie::INPUT_MOUSE_BUTTON_LEFT)
-		&& m_game->isMouseInGame())
+		&& m_sim->getGame()->isMouseInGame())
 	{
 		getTileAtMousePosition(&m_dragStartX, &m_dragStartY);
 		// only start dragging if we're within the bounds of the world
@@ -65,10 +115,7 @@ void TileManager::updateZoneEditing()
 			{
 				for (int x = dragMinX; x <= dragMaxX; ++x)
 				{
-					Tile* t = (*m_tiles)[y][x];
-					if (!t)
-						continue;
-					t->setZoneType(m_selectedType);
+					m_tiles->setZoneType(x, y, m_selectedType);
 				}
 			}
 		}
@@ -91,7 +138,7 @@ void TileManager::drawZoneSelection(aie::Renderer2D* renderer) const
 	if (m_dragging)
 	{
 		renderer->setRenderColour(1, 1, 1);
-		m_game->drawTileRect(m_dragStartX, m_dragStartY, m_dragEndX,
+		m_sim->getGame()->drawTileRect(m_dragStartX, m_dragStartY, m_dragEndX,
 			m_dragEndY);
 	}
 }
@@ -99,23 +146,257 @@ void TileManager::drawZoneSelection(aie::Renderer2D* renderer) const
 void TileManager::getTileAtMousePosition(int* ix, int* iy) const
 {
 	// first get the mouse's world position
-	Vector2 mousePos = m_game->getMouseWorldPosition();
+	Vector2 mousePos = m_sim->getMouseWorldPosition();
 
 	// then grab the tile's indices
 	getTileAtPosition(mousePos, ix, iy);
 }
 
-Tile* TileManager::getTileAtPosition(Vector2& pos) const
+void TileManager::drawTiles(aie::Renderer2D* renderer, const TileView& view,
+	const LodLevel lod, const bool zoneTint)
+{
+	// start again if the grid's been resized
+	if (m_chunkGridWidth != m_tiles->getWidth()
+		|| m_chunkGridHeight != m_tiles->getHeight())
+	{
+		clearChunks();
+		m_chunkGridWidth = m_tiles->getWidth();
+		m_chunkGridHeight = m_tiles->getHeight();
+	}
+	if (view.maxY < view.minY)
+		return;
+
+	const int chunkSize = m_lodChunkSizes[lod];
+	const int chunksWide = (m_chunkGridWidth + chunkSize - 1) / chunkSize;
+	const int chunksHigh = (m_chunkGridHeight + chunkSize - 1) / chunkSize;
+	std::vector<TileChunk*>& chunks = m_chunks[lod];
+	if (chunks.empty())
+		chunks.resize(chunksWide * chunksHigh, nullptr);
+
+	// buildings are only drawn into the chunks once they're flat
+	bool flat = lod != LODLEVEL_FULL;
+	Game* game = m_sim->getGame();
+	bool buildings = flat && game->isViewModeEnabled(VIEWMODE_BUILDINGS);
+	bool roads = flat && game->isViewModeEnabled(VIEWMODE_ROADS);
+
+	// chunks go in the same order as the tiles in them, so the ones in
+	//   front are drawn last
+	for (int cy = view.minY / chunkSize; cy <= view.maxY / chunkSize; ++cy)
+	{
+		for (int cx = 0; cx < chunksWide; ++cx)
+		{
+			// skip chunks with no tiles in view
+			int minX = cx * chunkSize;
+			int minY = cy * chunkSize;
+			int maxX = minX + chunkSize - 1;
+			int maxY = minY + chunkSize - 1;
+			if (maxX - minY < view.minDiff || minX - maxY > view.maxDiff
+				|| maxX + maxY < view.minSum || minX + minY > view.maxSum)
+				continue;
+
+			TileChunk*& chunk = chunks[cy * chunksWide + cx];
+			if (!chunk)
+				chunk = new TileChunk();
+
+			unsigned int revision = getChunkRevision(lod, cx, cy,
+				buildings || roads);
+			if (!chunk->built || chunk->revision != revision
+				|| chunk->zoneTint != zoneTint
+				|| chunk->buildings != buildings || chunk->roads != roads)
+			{
+				chunk->zoneTint = zoneTint;
+				chunk->buildings = buildings;
+				chunk->roads = roads;
+				if (flat)
+					buildFlatChunk(renderer, chunk, lod, cx, cy);
+				else
+					buildChunk(renderer, chunk, cx, cy, zoneTint);
+				chunk->revision = revision;
+				chunk->built = true;
+			}
+
+			renderer->drawCache(&chunk->cache);
+		}
+	}
+}
+
+void TileManager::drawTile(aie::Renderer2D* renderer, const int x,
+	const int y) const
+{
+	// account for the difference in height in the texture
+	// and keep the bottoms aligned
+	float dify = TILE_HEIGHT - (float)m_tileSprite->getHeight();
+
+	// I'm not sure why I subtracted 20 here but let's go with it
+	Vector2 pos = getTileWorldPosition(x, y);
+	m_tileSprite->draw(renderer, pos.getX(), pos.getY() - 20.0f - dify / 2.0f,
+		0, getTileDepth(x, y), 0, 0.5f);
+}
+
+void TileManager::buildChunk(aie::Renderer2D* renderer, TileChunk* chunk,
+	const int chunkX, const int chunkY, const bool zoneTint)
+{
+	const int minX = chunkX * TILE_CHUNK_SIZE;
+	const int minY = chunkY * TILE_CHUNK_SIZE;
+	const int maxX = std::min(minX + TILE_CHUNK_SIZE, m_tiles->getWidth());
+	const int maxY = std::min(minY + TILE_CHUNK_SIZE, m_tiles->getHeight());
+
+	renderer->beginCache(&chunk->cache);
+	for (int y = minY; y < maxY; ++y)
+	{
+		for (int x = minX; x < maxX; ++x)
+		{
+			if (zoneTint)
+				renderer->setRenderColour(
+					m_zoneTintColours[m_tiles->getZoneType(x, y)]);
+			else
+				renderer->setRenderColour(0xffffffff);
+			drawTile(renderer, x, y);
+		}
+	}
+	renderer->endCache();
+}
+
+void TileManager::buildFlatChunk(aie::Renderer2D* renderer, TileChunk* chunk,
+	const LodLevel lod, const int chunkX, const int chunkY)
+{
+	const int chunkSize = m_lodChunkSizes[lod];
+	const int blockSize = m_lodBlockSizes[lod];
+	const int minX = chunkX * chunkSize;
+	const int minY = chunkY * chunkSize;
+	const int maxX = std::min(minX + chunkSize, m_tiles->getWidth());
+	const int maxY = std::min(minY + chunkSize, m_tiles->getHeight());
+
+	// a block of tiles is a diamond like a tile is, just bigger
+	// a row of diamonds with the same x + y can be swapped for rectangles
+	//   as wide as them and a third as tall, since the rows above and below
+	//   are shifted half a diamond across and fill in the gaps
+	const float tw = TILE_WIDTH / 2.0f;
+	const float th = TILE_HEIGHT / 3.0f;
+	const float blockWidth = tw * 2.0f * blockSize;
+	const float blockHeight = th * blockSize;
+	const float dify = TILE_HEIGHT - (float)m_tileSprite->getHeight();
+
+	renderer->beginCache(&chunk->cache);
+	for (int y = minY; y < maxY; y += blockSize)
+	{
+		for (int x = minX; x < maxX; x += blockSize)
+		{
+			// average the colours of every tile in the block
+			unsigned int r = 0, g = 0, b = 0, count = 0;
+			for (int by = y; by < std::min(y + blockSize, maxY); ++by)
+			{
+				for (int bx = x; bx < std::min(x + blockSize, maxX); ++bx)
+				{
+					unsigned int colour = getFlatColour(bx, by,
+						chunk->zoneTint, chunk->buildings, chunk->roads);
+					r += colour >> 24;
+					g += (colour >> 16) & 0xff;
+					b += (colour >> 8) & 0xff;
+					count++;
+				}
+			}
+			renderer->setRenderColour(
+				((r / count) << 24) | ((g / count) << 16)
+				| ((b / count) << 8) | 0xff);
+
+			// the middle of the block is half a block down from the middle
+			//   of its first tile, which is where drawTile centres it
+			Vector2 pos = getTileWorldPosition(x, y);
+			renderer->drawBox(pos.getX() + tw,
+				pos.getY() - 20.0f - dify / 2.0f - th * (blockSize - 1),
+				blockWidth, blockHeight, 0, TILE_DEPTH_BACK);
+		}
+	}
+	renderer->endCache();
+}
+
+unsigned int TileManager::getChunkRevision(const LodLevel lod,
+	const int chunkX, const int chunkY, const bool buildings) const
+{
+	// our chunks are made of whole TileGrid chunks
+	const int scale = m_lodChunkSizes[lod] / TILE_CHUNK_SIZE;
+	const int minX = chunkX * scale;
+	const int minY = chunkY * scale;
+	const int maxX = std::min(minX + scale, m_tiles->getChunksWide());
+	const int maxY = std::min(minY + scale, m_tiles->getChunksHigh());
+
+	unsigned int revision = 0;
+	for (int y = minY; y < maxY; ++y)
+	{
+		for (int x = minX; x < maxX; ++x)
+		{
+			revision = std::max(revision, m_tiles->getChunkRevision(x, y));
+			if (buildings)
+				revision = std::max(revision,
+					m_tiles->getChunkBuildingRevision(x, y));
+		}
+	}
+	return revision;
+}
+
+unsigned int TileManager::getFlatColour(const int x, const int y,
+	const bool zoneTint, const bool buildings, const bool roads) const
+{
+	Building* building = m_tiles->getBuilding(x, y);
+	if (building)
+	{
+		BuildingType type = building->getType();
+		if (type == BUILDINGTYPE_ROAD ? roads : buildings)
+			return m_buildingMarkerColours[type];
+	}
+
+	if (!zoneTint)
+		return TILE_FLAT_COLOUR;
+
+	// tint the grass the same way the sprite would be
+	unsigned int tint = m_zoneTintColours[m_tiles->getZoneType(x, y)];
+	unsigned int colour = 0xff;
+	for (int shift = 8; shift < 32; shift += 8)
+	{
+		unsigned int channel = ((TILE_FLAT_COLOUR >> shift) & 0xff)
+			* ((tint >> shift) & 0xff) / 0xff;
+		colour |= channel << shift;
+	}
+	return colour;
+}
+
+void TileManager::clearChunks()
+{
+	for (auto& chunks : m_chunks)
+	{
+		for (auto chunk : chunks)
+			delete chunk;
+		chunks.clear();
+	}
+}
+
+float TileManager::getTileDepth(const int x, const int y) const
+{
+	// the furthest x + y can be from the back corner
+	int furthest = m_tiles->getWidth() + m_tiles->getHeight() - 2;
+	if (furthest <= 0)
+		return TILE_DEPTH_BACK;
+
+	float along = (float)(x + y) / furthest;
+	return TILE_DEPTH_BACK + (TILE_DEPTH_FRONT - TILE_DEPTH_BACK) * along;
+}
+
+// returns whether or not the tile is suitable for living
+bool TileManager::isTileLiveable(const int x, const int y) const
 {
-	int ix, iy;
-	getTileAtPosition(pos, &ix, &iy);
+	if (!m_tiles->hasPower(x, y))
+		return false;
 
-	if (ix < 0 || iy < 0)
-		return nullptr;
-	return (*m_tiles)[iy][ix];
+	if (m_tiles->getZoneType(x, y) == ZONETYPE_NONE)
+		return false;
+
+	int roadDist = m_sim->getRoadManager()->getRoadDistance(x, y);
+
+	return roadDist <= 6;
 }
 
-void TileManager::getTileAtPosition(Vector2& pos, int* ix, int* iy) const
+void TileManager::getTileAtPosition(const Vector2& pos, int* ix, int* iy) const
 {
 	// get shorter names for the measurements we use to offset the tiles
 	const float tw = TILE_WIDTH / 2.0f;
@@ -129,7 +410,7 @@ void TileManager::getTileAtPosition(Vector2& pos, int* ix, int* iy) const
 	py *= -1;
 
 	// offset to the start of the map
-	Vector2 mapStart = m_game->getMapStart();
+	Vector2 mapStart = m_sim->getMapStart();
 	px -= mapStart.getX();
 	py += mapStart.getY();
 
@@ -141,9 +422,9 @@ void TileManager::getTileAtPosition(Vector2& pos, int* ix, int* iy) const
 	auto resultX = (int)((px / tw + py / th) / 2);
 	auto resultY = (int)((py / th - px / tw) / 2);
 
-	if (resultX < 0 || resultX >= WORLD_WIDTH)
+	if (resultX < 0 || resultX >= m_tiles->getWidth())
 		resultX = -1;
-	if (resultY < 0 || resultY >= WORLD_HEIGHT)
+	if (resultY < 0 || resultY >= m_tiles->getHeight())
 		resultY = -1;
 
 	*ix = resultX;
@@ -152,56 +433,74 @@ void TileManager::getTileAtPosition(Vector2& pos, int* ix, int* iy) const
 
 Vector2 TileManager::getTileWorldPosition(const int ix, const int iy) const
 {
-	Vector2 mapStart = m_game->getMapStart();
+	Vector2 mapStart = m_sim->getMapStart();
 	float xpos = (ix - iy) * TILE_WIDTH / 2.0f + mapStart.getX();
 	float ypos = (ix + iy) * TILE_HEIGHT / 3.0f - mapStart.getY();
 	// (apparently this is more modern than return Vector2(x,y) ??
 	return { xpos, -ypos };
 }
 
-bool TileManager::isIndexInBounds(const int x, const int y) const
+TileView TileManager::getTilesInView(float left, float bottom, float right,
+	float top) const
 {
-	return x >= 0 && y >= 0 && x < WORLD_WIDTH && y < WORLD_HEIGHT;
+	// get shorter names for the measurements we use to offset the tiles
+	const float tw = TILE_WIDTH / 2.0f;
+	const float th = TILE_HEIGHT / 3.0f;
+	Vector2 mapStart = m_sim->getMapStart();
+
+	left -= VIEW_CULL_MARGIN;
+	bottom -= VIEW_CULL_MARGIN;
+	right += VIEW_CULL_MARGIN;
+	top += VIEW_CULL_MARGIN;
+
+	TileView view;
+	// tiles are drawn from their left edge, so one a whole tile width left
+	//   of the screen can still poke in
+	view.minDiff = (int)ceilf((left - TILE_WIDTH - mapStart.getX()) / tw);
+	view.maxDiff = (int)floorf((right - mapStart.getX()) / tw);
+	// y goes down the screen as x + y goes up
+	view.minSum = (int)ceilf((mapStart.getY() - top) / th);
+	view.maxSum = (int)floorf((mapStart.getY() - bottom) / th);
+
+	// y = (sum - diff) / 2, so that's as far as the rows can go
+	view.minY = (view.minSum - view.maxDiff) / 2;
+	view.maxY = (view.maxSum - view.minDiff + 1) / 2;
+	if (view.minY < 0)
+		view.minY = 0;
+	if (view.maxY > m_tiles->getHeight() - 1)
+		view.maxY = m_tiles->getHeight() - 1;
+	view.lastX = m_tiles->getWidth() - 1;
+
+	return view;
 }
 
-void TileManager::clearTilePower()
+void TileView::getRow(int y, int* minX, int* maxX) const
 {
-	for (int y = 0; y < WORLD_HEIGHT; ++y)
-	{
-		for (int x = 0; x < WORLD_WIDTH; ++x)
-		{
-			Tile* t = getTile(x, y);
-			if (!t || !t->hasPower())
-				continue;
-			t->setPower(false);
-		}
-	}
+	// x has to keep both x - y and x + y inside the view
+	int rowMin = minDiff + y;
+	if (minSum - y > rowMin)
+		rowMin = minSum - y;
+	int rowMax = maxDiff + y;
+	if (maxSum - y < rowMax)
+		rowMax = maxSum - y;
+
+	*minX = rowMin < 0 ? 0 : rowMin;
+	*maxX = rowMax > lastX ? lastX : rowMax;
 }
 
-// deletes all tiles and the array, then reallocates it
-void TileManager::clearTiles(int width, int height)
+bool TileView::contains(int x, int y) const
 {
-	for (int y = 0; y < WORLD_HEIGHT; ++y)
-	{
-		for (int x = 0; x < WORLD_WIDTH; ++x)
-		{
-			if ((*m_tiles)[y][x] != nullptr)
-				delete (*m_tiles)[y][x];
-		}
-		// delete this column
-		delete[](*m_tiles)[y];
-	}
-	// delete the array of columns
-	delete[](*m_tiles);
+	return x - y >= minDiff && x - y <= maxDiff
+		&& x + y >= minSum && x + y <= maxSum;
+}
 
-	// reallocate
-	(*m_tiles) = new Tile**[height];
-	// initialize tiles to grass tiles
-	for (int y = 0; y < height; ++y)
-	{
-		(*m_tiles)[y] = new Tile*[width];
-		for (int x = 0; x < width; ++x)
-			(*m_tiles)[y][x] = new Tile(m_game,
-				m_game->getImageManager()->getTexture("tiles/grass_flat"));
-	}
+bool TileManager::isIndexInBounds(const int x, const int y) const
+{
+	return m_tiles->isInBounds(x, y);
 }
+
+// empties all tiles, reallocating the grid at the new size
+void TileManager::clearTiles(int width, int height)
+{
+	m_tiles->resize(width, height);
+}
\ No newline at end of file
@@ -1,23 +1,75 @@
 #pragma once
 
+#include <vector>
+
 #include "Renderer2D.h"
 
+#include "camera.h"
+#include "sprite.h"
 #include "vector2.h"
+#include "building.h"
+#include "tilegrid.h"
+
+class Simulation;
 
-enum ZoneType;
+// how far outside the screen (in world units) things are still drawn
+// leaves room for tall and wide sprites like the 4x4 PowerPlant, whose
+//   root tile can be off screen while the rest of it isn't
+#define VIEW_CULL_MARGIN (TILE_WIDTH * 3.0f)
+// how far back tiles are drawn, from the back corner of the map at
+//   TILE_DEPTH_BACK to the front corner at TILE_DEPTH_FRONT, so a tile drawn
+//   late still ends up behind the ones in front of it
+// anything drawn at a lower depth (like buildings, at 0) is in front of them
+#define TILE_DEPTH_BACK 100.0f
+#define TILE_DEPTH_FRONT 1.0f
+// colour of an empty tile when tiles are drawn flat, about the average
+//   colour of the grass sprite
+#define TILE_FLAT_COLOUR 0x859a44ff
 
-class Game;
-class Tile;
+// the tiles that can be seen, worked out by TileManager::getTilesInView
+// isometric tiles line up on screen by x - y (columns) and x + y (rows),
+//   so the view is a range of each
+struct TileView
+{
+	int minDiff, maxDiff;
+	int minSum, maxSum;
+	// rows of the grid with any visible tiles
+	int minY, maxY;
+	// the last column in the world, so rows don't run off the edge
+	int lastX;
+
+	//------------------------------------------------------------------------
+	// Gets which tiles in a row of the grid can be seen
+	// minX will be greater than maxX if none can
+	//
+	// Param:
+	//			y:    y index of the row
+	//			minX: pointer to where the first visible x index is stored
+	//			maxX: pointer to where the last visible x index is stored
+	//------------------------------------------------------------------------
+	void getRow(int y, int* minX, int* maxX) const;
+	//------------------------------------------------------------------------
+	// Checks if a tile can be seen
+	//
+	// Param:
+	//			x: x index of the tile
+	//			y: y index of the tile
+	// Return:
+	//			whether or not the tile is in view
+	//------------------------------------------------------------------------
+	bool contains(int x, int y) const;
+};
 
 class TileManager
 {
 public:
 	//------------------------------------------------------------------------
 	// Param:
-	//			game:  pointer to our Game so we can access everything we need
-	//			tiles: pointer to the 2D array of Tile pointers
+	//			sim:   pointer to our Simulation so we can access everything
+	//			tiles: pointer to the grid holding every tile's values
 	//------------------------------------------------------------------------
-	TileManager(Game* game, Tile**** tiles);
+	TileManager(Simulation* sim, TileGrid* tiles);
+	~TileManager();
 
 	//------------------------------------------------------------------------
 	// Called every frame when in zone editing mode
@@ -34,17 +86,43 @@ public:
 	void drawZoneSelection(aie::Renderer2D* renderer) const;
 
 	//------------------------------------------------------------------------
-	// Gets a pointer to the tile at a specified index in the 2D array
-	// Simply indexes the array, so the input should always be checked 
-	// beforehand
+	// Draws every tile in view, with one draw call for each chunk of tiles
+	// Chunks are kept on the GPU and only built again when what's in them
+	//   changes or zone tinting is turned on or off
+	// Past LODLEVEL_FULL, tiles are drawn as flat colours with the
+	//   buildings on them as markers, so BuildingManager::drawBuildings
+	//   isn't needed and the cost doesn't grow with the number of buildings
+	//
+	// Param: 
+	//			renderer: pointer to the renderer used to draw everything
+	//			view:     the tiles to draw
+	//			lod:      how much detail to draw with
+	//			zoneTint: whether tiles should have the colour of their zone
+	//------------------------------------------------------------------------
+	void drawTiles(aie::Renderer2D* renderer, const TileView& view,
+		LodLevel lod, bool zoneTint);
+	//------------------------------------------------------------------------
+	// Draws one tile in the renderer's current colour, at the same depth
+	//   drawTiles puts it, so the tiles in front of it still cover it
 	//
 	// Param: 
-	//			x: x index of the desired tile
-	//			y: y index of the desired tile
+	//			renderer: pointer to the renderer used to draw everything
+	//			x:        x index of the tile
+	//			y:        y index of the tile
+	//------------------------------------------------------------------------
+	void drawTile(aie::Renderer2D* renderer, int x, int y) const;
+
+	//------------------------------------------------------------------------
+	// Gets whether or not a tile is able to spawn buildings
+	// Based on whether or not it has power, has a zone and has a close road
+	//
+	// Param: 
+	//			x: x index of the tile
+	//			y: y index of the tile
 	// Return: 
-	//			the tile at that location
+	//			whether or not the tile is suitable for buildings
 	//------------------------------------------------------------------------
-	Tile* getTile(int x, int y) const { return (*m_tiles)[y][x]; }
+	bool isTileLiveable(int x, int y) const;
 	//------------------------------------------------------------------------
 	// Grabs the tile index which is under the mouse's world position
 	// Indices will be -1 if no tile is found
@@ -55,15 +133,6 @@ public:
 	//------------------------------------------------------------------------
 	void	getTileAtMousePosition(int *ix, int *iy) const;
 	//------------------------------------------------------------------------
-	// Gets a pointer to the tile at a specified world position
-	//
-	// Param: 
-	//			pos: Vector2 representing the position to search for
-	// Return: 
-	//			the tile at the position OR nullptr if no tile exists there
-	//------------------------------------------------------------------------
-	Tile*	getTileAtPosition(Vector2& pos) const;
-	//------------------------------------------------------------------------
 	// Gets the index to the tile at a specified world position
 	//
 	// Param: 
@@ -71,7 +140,7 @@ public:
 	//			ix:  pointer to where the resulting x index should be stored 
 	//			iy:  pointer to where the resulting y index should be stored 
 	//------------------------------------------------------------------------
-	void	getTileAtPosition(Vector2& pos, int* ix, int* iy) const;
+	void	getTileAtPosition(const Vector2& pos, int* ix, int* iy) const;
 	//------------------------------------------------------------------------
 	// Gets the world position of the tile at the specified index
 	//
@@ -83,8 +152,22 @@ public:
 	//------------------------------------------------------------------------
 	Vector2 getTileWorldPosition(int ix, int iy) const;
 	//------------------------------------------------------------------------
+	// Works out which tiles are drawn inside part of the world
+	// The inverse of getTileWorldPosition, done for a whole rectangle
+	//
+	// Param: 
+	//			left:   left edge of the rectangle in world units
+	//			bottom: bottom edge of the rectangle in world units
+	//			right:  right edge of the rectangle in world units
+	//			top:    top edge of the rectangle in world units
+	// Return: 
+	//			the tiles in the rectangle, clipped to the world
+	//------------------------------------------------------------------------
+	TileView getTilesInView(float left, float bottom, float right,
+		float top) const;
+	//------------------------------------------------------------------------
 	// Checks if an index is within the world bounds
-	// Useful for checking the indices before using getTile
+	// Useful for checking the indices before using the TileGrid
 	//
 	// Param: 
 	//			x: x index to check
@@ -93,18 +176,13 @@ public:
 	//			whether or not the indices are within the bounds of the world
 	//------------------------------------------------------------------------
 	bool	isIndexInBounds(int x, int y) const;
-	//------------------------------------------------------------------------
-	// Sets all tiles to have no power
-	// Used when updating tile power
-	//------------------------------------------------------------------------
-	void	clearTilePower();
 
 	//------------------------------------------------------------------------
-	// Deletes all tiles and creates a new array of them
+	// Clears all tiles and resizes the grid
 	//
 	// Param: 
-	//			width:  the width of the new array
-	//			height: the height of the new array
+	//			width:  the width of the new grid
+	//			height: the height of the new grid
 	//------------------------------------------------------------------------
 	void clearTiles(int width, int height);
 
@@ -125,9 +203,54 @@ public:
 	//------------------------------------------------------------------------
 	ZoneType getSelectedType() const { return m_selectedType; }
 private:
-	Game* m_game;
-	// a pointer to the 2D array of Tile pointers
-	Tile****	m_tiles;
+	Simulation* m_sim;
+	// the values of every tile in the world
+	TileGrid*	m_tiles;
+	Sprite*		m_tileSprite;
+
+	// colours to tint tiles when zone tinting is enabled
+	static const unsigned int m_zoneTintColours[ZONETYPE_COUNT];
+	// colours of the markers buildings are drawn as past LODLEVEL_FULL
+	static const unsigned int m_buildingMarkerColours[BUILDINGTYPE_COUNT];
+	// how many tiles along each side of a chunk at each level of detail,
+	//   and how many tiles along each side share one colour
+	static const int m_lodChunkSizes[LODLEVEL_COUNT];
+	static const int m_lodBlockSizes[LODLEVEL_COUNT];
+
+	// a chunk of tiles kept on the GPU by drawTiles
+	struct TileChunk
+	{
+		aie::SpriteCache cache;
+		// what the cache was built from, so we know when it's out of date
+		unsigned int revision = 0;
+		bool zoneTint = false;
+		bool buildings = false;
+		bool roads = false;
+		bool built = false;
+	};
+	// one for every chunk at each level of detail, made when they're first
+	//   drawn
+	std::vector<TileChunk*> m_chunks[LODLEVEL_COUNT];
+	// the size of the grid the chunks were made for
+	int m_chunkGridWidth, m_chunkGridHeight;
+
+	// records a chunk's tiles into its cache again
+	void buildChunk(aie::Renderer2D* renderer, TileChunk* chunk, int chunkX,
+		int chunkY, bool zoneTint);
+	// records a chunk's tiles into its cache as flat colours
+	void buildFlatChunk(aie::Renderer2D* renderer, TileChunk* chunk,
+		LodLevel lod, int chunkX, int chunkY);
+	// gets the newest revision of the TileGrid chunks inside one of our
+	//   chunks, counting building changes too if buildings is true
+	unsigned int getChunkRevision(LodLevel lod, int chunkX, int chunkY,
+		bool buildings) const;
+	// gets the colour a tile is drawn as past LODLEVEL_FULL
+	unsigned int getFlatColour(int x, int y, bool zoneTint, bool buildings,
+		bool roads) const;
+	// throws away every chunk's cache
+	void clearChunks();
+	// how far back a tile is drawn, see TILE_DEPTH_BACK
+	float getTileDepth(int x, int y) const;
 
 	// zone creation variables
 	ZoneType m_selectedType;
@@ -4,6 +4,7 @@
 #include "Input.h"
 
 #include "game.h"
+#include "citystats.h"
 #include "tilemanager.h"
 #include "imagemanager.h"
 #include "buildingmanager.h"
@@ -75,21 +76,21 @@ UiManager::UiManager(Game* game)
 
 	ImageManager* img = m_game->getImageManager();
 	m_buildingIcons[BUILDINGTYPE_NONE] =
-		img->getTexture("icons/demolish");
+		img->getSprite(SPRITE_ICON_DEMOLISH);
 	m_buildingIcons[BUILDINGTYPE_POWERPLANT] =
-		img->getTexture("icons/powerplant");
+		img->getSprite(SPRITE_ICON_POWERPLANT);
 	m_buildingIcons[BUILDINGTYPE_POWERPOLE] =
-		img->getTexture("icons/powerpole");
+		img->getSprite(SPRITE_ICON_POWERPOLE);
 	m_buildingIcons[BUILDINGTYPE_ROAD] =
-		img->getTexture("icons/road");
+		img->getSprite(SPRITE_ICON_ROAD);
 
 	m_buildingNames[BUILDINGTYPE_NONE] = "Demolish";
 	m_buildingNames[BUILDINGTYPE_POWERPLANT] = "Power Plant";
 	m_buildingNames[BUILDINGTYPE_POWERPOLE] = "Power Pole";
 	m_buildingNames[BUILDINGTYPE_ROAD] = "Road";
 
-	m_buildingSelectorIcon = img->getTexture("icons/building");
-	m_zoneSelectorIcon = img->getTexture("icons/zone");
+	m_buildingSelectorIcon = img->getSprite(SPRITE_ICON_BUILDING);
+	m_zoneSelectorIcon = img->getSprite(SPRITE_ICON_ZONE);
 }
 
 void UiManager::update(float delta)
@@ -153,13 +154,13 @@ void UiManager::update(float delta)
 
 	// smooth the demand values
 	const float demandSmoothSpeed = 10.0f;
-	BuildingManager* bm = m_game->getBuildingManager();
-	m_resDemand -= (m_resDemand - bm->getDemand(ZONETYPE_RESIDENTIAL))
+	CityStats* stats = m_game->getStats();
+	m_resDemand -= (m_resDemand - stats->getDisplayDemand(ZONETYPE_RESIDENTIAL))
+		* delta * demandSmoothSpeed;
+	m_comDemand -= (m_comDemand - stats->getDisplayDemand(ZONETYPE_COMMERCIAL))
+		* delta * demandSmoothSpeed;
+	m_indDemand -= (m_indDemand - stats->getDisplayDemand(ZONETYPE_INDUSTRIAL))
 		* delta * demandSmoothSpeed;
-	m_comDemand -= (m_comDemand - bm->getDemand(ZONETYPE_COMMERCIAL))
-		* delta * demandSmoothSpeed;;
-	m_indDemand -= (m_indDemand - bm->getDemand(ZONETYPE_INDUSTRIAL))
-		* delta * demandSmoothSpeed;;
 }
 
 void UiManager::draw(aie::Renderer2D* renderer)
@@ -183,10 +184,10 @@ void UiManager::draw(aie::Renderer2D* renderer)
 	// selector icons
 	renderer->setRenderColour(1, 1, 1);
 	float buildingIconX = m_selectorBox.x - (m_selectorBox.width / 4.0f);
-	renderer->drawSprite(m_buildingSelectorIcon,
+	m_buildingSelectorIcon->draw(renderer,
 		buildingIconX, m_selectorBox.y);
 	float zoneIconX = m_selectorBox.x + (m_selectorBox.width / 4.0f);
-	renderer->drawSprite(m_zoneSelectorIcon, zoneIconX, m_selectorBox.y);
+	m_zoneSelectorIcon->draw(renderer, zoneIconX, m_selectorBox.y);
 
 	if (m_mouseOverGraph)
 		drawDemandMouseover(renderer);
@@ -267,7 +268,7 @@ void UiManager::drawBuildingPanel(aie::Renderer2D* renderer)
 
 		// draw building icon
 		renderer->setRenderColour(1, 1, 1);
-		renderer->drawSprite(m_buildingIcons[i], xPos,
+		m_buildingIcons[i]->draw(renderer, xPos,
 			yPos + thisRect.height / 6.0f);
 
 		// draw building name
@@ -313,7 +314,7 @@ void UiManager::drawZonePanel(aie::Renderer2D* renderer)
 		if (i == ZONETYPE_NONE)
 		{
 			renderer->setRenderColour(1, 1, 1, 1);
-			renderer->drawSprite(m_buildingIcons[0], xPos,
+			m_buildingIcons[0]->draw(renderer, xPos,
 				yPos + thisRect.height / 6.0f);
 		}
 
@@ -2,7 +2,7 @@
 
 #include "Renderer2D.h"
 
-#include "tile.h" // for ZONETYPE_COUNT enum
+#include "tilegrid.h" // for ZONETYPE_COUNT enum
 #include "building.h" // for BUILDINGTYPE_COUNT enum
 
 // these could be an enum
@@ -98,13 +98,13 @@ private:
 	Rect m_buildingBoxes[BUILDINGTYPE_COUNT];
 
 	// icons for the selector box
-	aie::Texture* m_buildingSelectorIcon;
-	aie::Texture* m_zoneSelectorIcon;
+	Sprite* m_buildingSelectorIcon;
+	Sprite* m_zoneSelectorIcon;
 
 	// information to show in panels
 	unsigned int	m_zoneColours[ZONETYPE_COUNT];
 	const char*		m_zoneNames[ZONETYPE_COUNT];
-	aie::Texture*	m_buildingIcons[BUILDINGTYPE_COUNT];
+	Sprite*			m_buildingIcons[BUILDINGTYPE_COUNT];
 	const char*		m_buildingNames[BUILDINGTYPE_COUNT];
 
 	// drawing each panel
@@ -35,7 +35,7 @@ float Vector2::angle()
 	return atan2f(m_y, m_x);
 }
 
-float Vector2::distanceTo(Vector2& vec)
+float Vector2::distanceTo(const Vector2& vec)
 {
 	float distX = m_x - vec.getX();
 	float distY = m_y - vec.getY();
@@ -44,19 +44,19 @@ float Vector2::distanceTo(Vector2& vec)
 
 // distance without the need for sqrt
 // useful for comparisons, when the actual distance isn't required
-float Vector2::distanceToSquared(Vector2& vec)
+float Vector2::distanceToSquared(const Vector2& vec)
 {
 	float distX = m_x - vec.getX();
 	float distY = m_y - vec.getY();
 	return (distX*distX) + (distY*distY);
 }
 
-Vector2 Vector2::operator+(Vector2& vec)
+Vector2 Vector2::operator+(const Vector2& vec)
 {
 	return Vector2(m_x + vec.getX(), m_y + vec.getY());
 }
 
-Vector2 Vector2::operator-(Vector2& vec)
+Vector2 Vector2::operator-(const Vector2& vec)
 {
 	return Vector2(m_x - vec.getX(), m_y - vec.getY());
 }
@@ -73,21 +73,21 @@ Vector2::Vector2(const Vector2& vec)
 	m_y = vec.getY();
 }
 
-Vector2& Vector2::operator=(Vector2& vec)
+Vector2& Vector2::operator=(const Vector2& vec)
 {
 	m_x = vec.getX();
 	m_y = vec.getY();
 	return *this;
 }
 
-Vector2& Vector2::operator+=(Vector2& vec)
+Vector2& Vector2::operator+=(const Vector2& vec)
 {
 	m_x += vec.getX();
 	m_y += vec.getY();
 	return *this;
 }
 
-Vector2& Vector2::operator-=(Vector2& vec)
+Vector2& Vector2::operator-=(const Vector2& vec)
 {
 	m_x -= vec.getX();
 	m_y -= vec.getY();
@@ -95,13 +95,13 @@ Vector2& Vector2::operator-=(Vector2& vec)
 }
 
 // returns the dot product of two vectors
-float Vector2::operator*(Vector2& vec)
+float Vector2::operator*(const Vector2& vec)
 {
 	return m_x * vec.getX() + m_y * vec.getY();
 }
 
 // might be kinda useless with float inaccuracies
-bool Vector2::operator==(Vector2& vec)
+bool Vector2::operator==(const Vector2& vec)
 {
 	return (m_x == vec.getX() && m_y == vec.getY());
 }
@@ -31,18 +31,18 @@ public:
 
 	float angle();
 
-	float distanceTo(Vector2& vec);
-	float distanceToSquared(Vector2& vec);
+	float distanceTo(const Vector2& vec);
+	float distanceToSquared(const Vector2& vec);
 
 	// operator overloads
-	Vector2  operator+ (Vector2& vec);
-	Vector2  operator- (Vector2& vec);
+	Vector2  operator+ (const Vector2& vec);
+	Vector2  operator- (const Vector2& vec);
 	Vector2  operator* (float mul);
-	Vector2& operator= (Vector2& vec);
-	Vector2& operator+=(Vector2& vec);
-	Vector2& operator-=(Vector2& vec);
-	float    operator* (Vector2& vec);
-	bool	 operator==(Vector2& vec);
+	Vector2& operator= (const Vector2& vec);
+	Vector2& operator+=(const Vector2& vec);
+	Vector2& operator-=(const Vector2& vec);
+	float    operator* (const Vector2& vec);
+	bool	 operator==(const Vector2& vec);
 private:
 	float m_x, m_y;
 };